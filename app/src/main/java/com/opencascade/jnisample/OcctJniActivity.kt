@@ -31,8 +31,10 @@ import android.content.pm.PackageManager
 import android.content.res.AssetManager
 import android.content.res.Configuration
 import android.graphics.Point
+import android.net.Uri
 import android.os.Bundle
 import android.os.Environment
+import android.provider.OpenableColumns
 import android.text.Html
 import android.text.Html.ImageGetter
 import android.util.TypedValue
@@ -42,11 +44,13 @@ import android.view.View
 import android.view.ViewGroup
 import android.widget.ImageButton
 import android.widget.LinearLayout
+import android.widget.SeekBar
 import android.widget.TextView
 import android.widget.Toast
 import java.io.*
 import java.lang.reflect.InvocationTargetException
 import java.lang.reflect.Method
+import java.nio.channels.FileChannel
 import java.util.*
 import kotlin.jvm.Throws
 
@@ -134,9 +138,7 @@ class OcctJniActivity : Activity(), View.OnClickListener {
         onConfigurationChanged(resources.configuration)
         val anIntent = intent
         val aDataUrl = anIntent?.data
-        val aDataPath = if (aDataUrl != null) aDataUrl.path else ""
-        myOcctView!!.open(aDataPath)
-        myLastPath = aDataPath
+        myLastPath = openDataUrl(aDataUrl)
         myContext = ContextWrapper(this)
         myContext!!.getExternalFilesDir(null)
     }
@@ -192,6 +194,31 @@ class OcctJniActivity : Activity(), View.OnClickListener {
         val anInfoButton = findViewById(R.id.info) as ImageButton
         anInfoButton.setOnClickListener(this)
 
+        // picking mode
+        val aPickButton = findViewById(R.id.gpu_pick) as ImageButton
+        aPickButton.setOnClickListener(this)
+
+        // compact vertex format
+        val aCompactButton = findViewById(R.id.compact) as ImageButton
+        aCompactButton.setOnClickListener(this)
+
+        // occlusion culling
+        val anOcclusionButton = findViewById(R.id.occlusion) as ImageButton
+        anOcclusionButton.setOnClickListener(this)
+
+        // section
+        val aSectionButton = findViewById(R.id.section) as ImageButton
+        aSectionButton.setOnClickListener(this)
+        val aSectionSlider = findViewById(R.id.section_slider) as SeekBar
+        aSectionSlider.setOnSeekBarChangeListener(object : SeekBar.OnSeekBarChangeListener {
+            override fun onProgressChanged(theSlider: SeekBar, theProgress: Int, theFromUser: Boolean) {
+                myOcctView!!.setSectionPlane(mySectionAxis, theProgress.toFloat() / theSlider.max.toFloat())
+            }
+
+            override fun onStartTrackingTouch(theSlider: SeekBar) {}
+            override fun onStopTrackingTouch(theSlider: SeekBar) {}
+        })
+
         // font for text view
         val anInfoView = findViewById(R.id.info_view) as TextView
         anInfoView.setTextSize(TypedValue.COMPLEX_UNIT_SP, 18f)
@@ -225,13 +252,57 @@ class OcctJniActivity : Activity(), View.OnClickListener {
         myOcctView!!.onResume()
         val anIntent = intent
         val aDataUrl = anIntent?.data
-        val aDataPath = if (aDataUrl != null) aDataUrl.path else ""
+        val aDataPath = if (aDataUrl != null) aDataUrl.toString() else ""
         if (aDataPath != myLastPath) {
-            myOcctView!!.open(aDataPath)
-            myLastPath = aDataPath
+            myLastPath = openDataUrl(aDataUrl)
         }
     }
 
+    //! Open file from intent data.
+    //! Content URIs are passed to native code as memory-mapped buffers (for formats readable from memory)
+    //! or as file descriptors to avoid copying into temporary file.
+    //! Returns the string identifying opened data.
+    private fun openDataUrl(theDataUrl: Uri?): String {
+        if (theDataUrl == null) {
+            myOcctView!!.open("")
+            return ""
+        }
+        if (theDataUrl.scheme != "content") {
+            myOcctView!!.open(theDataUrl.path ?: "")
+            return theDataUrl.toString()
+        }
+
+        // file name is required to detect the format
+        var aName = theDataUrl.lastPathSegment ?: ""
+        try {
+            contentResolver.query(theDataUrl, arrayOf(OpenableColumns.DISPLAY_NAME), null, null, null)?.use { theCursor ->
+                if (theCursor.moveToFirst() && !theCursor.isNull(0)) {
+                    aName = theCursor.getString(0)
+                }
+            }
+            val aFileDesc = contentResolver.openFileDescriptor(theDataUrl, "r")
+            if (aFileDesc == null) {
+                OcctJniLogger.postMessage("Error: file '$aName' can not be opened")
+                return theDataUrl.toString()
+            }
+            val aFormat = aName.substringAfterLast('.', "").toLowerCase(Locale.ROOT)
+            if (aFormat in MEMORY_FORMATS
+             && aFileDesc.statSize in 1L..Int.MAX_VALUE.toLong()) {
+                // mapping remains valid after closing the descriptor
+                aFileDesc.use { theDesc ->
+                    FileInputStream(theDesc.fileDescriptor).channel.use { theChannel ->
+                        myOcctView!!.openBuffer(theChannel.map(FileChannel.MapMode.READ_ONLY, 0, theDesc.statSize), aName)
+                    }
+                }
+            } else {
+                myOcctView!!.openFd(aFileDesc.detachFd(), aName)
+            }
+        } catch (theError: Exception) {
+            OcctJniLogger.postMessage("Error: file '$aName' can not be opened:\n  ${theError.message}")
+        }
+        return theDataUrl.toString()
+    }
+
     //! Copy folder from assets
     private fun copyAssetFolder(theAssetMgr: AssetManager,
                                 theAssetFolder: String,
@@ -336,6 +407,39 @@ class OcctJniActivity : Activity(), View.OnClickListener {
                 myOcctView!!.fitAll()
                 return
             }
+            R.id.gpu_pick -> {
+                myIsGpuPicking = !myIsGpuPicking
+                aClickedBtn.setBackgroundColor(resources.getColor(if (myIsGpuPicking) R.color.pressedBtnColor else R.color.btnColor))
+                printShortInfo(this, if (myIsGpuPicking) "GPU picking" else "CPU picking")
+                myOcctView!!.setGpuPicking(myIsGpuPicking)
+                return
+            }
+            R.id.compact -> {
+                myIsCompactVertices = !myIsCompactVertices
+                aClickedBtn.setBackgroundColor(resources.getColor(if (myIsCompactVertices) R.color.pressedBtnColor else R.color.btnColor))
+                printShortInfo(this, if (myIsCompactVertices) "Compact vertices ON" else "Compact vertices OFF")
+                myOcctView!!.setCompactVertices(myIsCompactVertices)
+                return
+            }
+            R.id.occlusion -> {
+                myIsCullingOccluded = !myIsCullingOccluded
+                aClickedBtn.setBackgroundColor(resources.getColor(if (myIsCullingOccluded) R.color.pressedBtnColor else R.color.btnColor))
+                printShortInfo(this, if (myIsCullingOccluded) "Occlusion culling ON" else "Occlusion culling OFF")
+                myOcctView!!.setOcclusionCulling(myIsCullingOccluded)
+                return
+            }
+            R.id.section -> {
+                // cycle section plane normal: off -> X -> Y -> Z -> off
+                mySectionAxis = if (mySectionAxis < 2) mySectionAxis + 1 else -1
+                val aSectionSlider = findViewById(R.id.section_slider) as SeekBar
+                aSectionSlider.visibility = if (mySectionAxis >= 0) View.VISIBLE else View.GONE
+                aClickedBtn.setBackgroundColor(resources.getColor(if (mySectionAxis >= 0) R.color.pressedBtnColor else R.color.btnColor))
+                if (mySectionAxis >= 0) {
+                    printShortInfo(this, "Section plane normal: " + "XYZ"[mySectionAxis])
+                }
+                myOcctView!!.setSectionPlane(mySectionAxis, aSectionSlider.progress.toFloat() / aSectionSlider.max.toFloat())
+                return
+            }
             R.id.proj_front -> {
                 myOcctView!!.setProj(OcctJniRenderer.TypeOfOrientation.Xpos)
                 return
@@ -630,6 +734,10 @@ class OcctJniActivity : Activity(), View.OnClickListener {
     private var myContext: ContextWrapper? = null
     private var myFileOpenDialog: OcctJniFileDialog? = null
     private var myButtonPreferSize = 65
+    private var mySectionAxis = -1
+    private var myIsGpuPicking = false
+    private var myIsCullingOccluded = false
+    private var myIsCompactVertices = false
 
     companion object {
         //! Auxiliary method to print temporary info messages
@@ -682,6 +790,9 @@ class OcctJniActivity : Activity(), View.OnClickListener {
             }
         }
 
+        //! Formats which native readers can parse from memory.
+        private val MEMORY_FORMATS = arrayOf("stp", "step", "brep", "rle", "stl")
+
         //! Message gravity.
         private const val Message_Trace = 0
         private const val Message_Info = 1
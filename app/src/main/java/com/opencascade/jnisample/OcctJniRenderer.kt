@@ -22,6 +22,8 @@
 package com.opencascade.jnisample
 
 import android.opengl.GLSurfaceView
+import android.os.ParcelFileDescriptor
+import java.nio.ByteBuffer
 import javax.microedition.khronos.egl.EGLConfig
 import javax.microedition.khronos.opengles.GL10
 
@@ -45,11 +47,34 @@ class OcctJniRenderer internal constructor(theView: GLSurfaceView?,
         }
     }
 
+    //! Open file from file descriptor (closed afterwards) without making a copy.
+    //! File name defines the format.
+    fun openFd(theFd: Int, theName: String) {
+        if (myCppViewer != 0L) {
+            cppOpenFd(myCppViewer, theFd, theName)
+        } else {
+            // native code takes ownership of the descriptor - close it here instead
+            ParcelFileDescriptor.adoptFd(theFd).close()
+        }
+    }
+
+    //! Open file from direct (or memory-mapped) buffer without making a copy.
+    //! Data between buffer position and limit is read.
+    //! File name defines the format; only STEP, BRep and STL can be read from memory.
+    fun openBuffer(theBuffer: ByteBuffer, theName: String) {
+        if (myCppViewer != 0L) {
+            cppOpenBuffer(myCppViewer, theBuffer, theBuffer.position(), theBuffer.limit(), theName)
+        }
+    }
+
     //! Update viewer.
     override fun onDrawFrame(theGl: GL10) {
         if (myCppViewer != 0L) {
             if (cppRedraw(myCppViewer)) {
                 myView!!.requestRender() // this method is allowed from any thread
+            } else if (cppHasBackgroundWork(myCppViewer)) {
+                // poll background computations at low rate instead of rendering continuously
+                myView!!.postDelayed({ myView!!.requestRender() }, BACKGROUND_POLL_DELAY_MS)
             }
         }
     }
@@ -95,6 +120,27 @@ class OcctJniRenderer internal constructor(theView: GLSurfaceView?,
         }
     }
 
+    //! Switch between GPU (ID buffer) and CPU (selection structures) picking.
+    fun setGpuPicking(theToUseGpu: Boolean) {
+        if (myCppViewer != 0L) {
+            cppSetGpuPicking(myCppViewer, theToUseGpu)
+        }
+    }
+
+    //! Switch compact (quantized) vertex format of shaded presentation.
+    fun setCompactVertices(theToUseCompact: Boolean) {
+        if (myCppViewer != 0L) {
+            cppSetCompactVertices(myCppViewer, theToUseCompact)
+        }
+    }
+
+    //! Switch occlusion culling of assembly parts.
+    fun setOcclusionCulling(theToCull: Boolean) {
+        if (myCppViewer != 0L) {
+            cppSetOcclusionCulling(myCppViewer, theToCull)
+        }
+    }
+
     //! Fit All
     fun fitAll() {
         if (myCppViewer != 0L) {
@@ -117,6 +163,15 @@ class OcctJniRenderer internal constructor(theView: GLSurfaceView?,
         }
     }
 
+    //! Set section plane.
+    //! @param theAxis     plane normal (0 for X, 1 for Y, 2 for Z) or -1 to turn sectioning off
+    //! @param thePosition plane position within shape bounding box in [0, 1] range
+    fun setSectionPlane(theAxis: Int, thePosition: Float) {
+        if (myCppViewer != 0L) {
+            cppSetSectionPlane(myCppViewer, theAxis, thePosition)
+        }
+    }
+
     //! Post message to the text view.
     fun postMessage(theText: String?) {
         OcctJniLogger.postMessage(theText)
@@ -137,6 +192,12 @@ class OcctJniRenderer internal constructor(theView: GLSurfaceView?,
     //! Open CAD file
     private external fun cppOpen(theCppPtr: Long, thePath: String)
 
+    //! Open CAD file from file descriptor
+    private external fun cppOpenFd(theCppPtr: Long, theFd: Int, theName: String)
+
+    //! Open CAD file from direct buffer
+    private external fun cppOpenBuffer(theCppPtr: Long, theBuffer: ByteBuffer, thePosition: Int, theLimit: Int, theName: String)
+
     //! Add touch point
     private external fun cppAddTouchPoint(theCppPtr: Long, theId: Int, theX: Float, theY: Float)
 
@@ -149,10 +210,22 @@ class OcctJniRenderer internal constructor(theView: GLSurfaceView?,
     //! Select in 3D Viewer.
     private external fun cppSelectInViewer(theCppPtr: Long, theX: Float, theY: Float)
 
+    //! Switch picking mode.
+    private external fun cppSetGpuPicking(theCppPtr: Long, theToUseGpu: Boolean)
+
+    //! Switch compact (quantized) vertex format of shaded presentation.
+    private external fun cppSetCompactVertices(theCppPtr: Long, theToUseCompact: Boolean)
+
+    //! Switch occlusion culling of assembly parts.
+    private external fun cppSetOcclusionCulling(theCppPtr: Long, theToCull: Boolean)
+
     //! Redraw OCCT viewer
     //! Returns TRUE if more frames are requested.
     private external fun cppRedraw(theCppPtr: Long): Boolean
 
+    //! Returns TRUE if background computations are running, which results should be displayed later.
+    private external fun cppHasBackgroundWork(theCppPtr: Long): Boolean
+
     //! Fit All
     private external fun cppFitAll(theCppPtr: Long)
 
@@ -173,9 +246,16 @@ class OcctJniRenderer internal constructor(theView: GLSurfaceView?,
 
     //! Move camera
     private external fun cppSetZnegProj(theCppPtr: Long)
+
+    //! Set section plane
+    private external fun cppSetSectionPlane(theCppPtr: Long, theAxis: Int, thePosition: Float)
     private var myView: GLSurfaceView? = null //!< back reference to the View
     private var myCppViewer: Long = 0 //!< pointer to c++ class instance
 
+    companion object {
+        private const val BACKGROUND_POLL_DELAY_MS = 50L //!< delay between frames polling background computations
+    }
+
     //! Empty constructor.
     init {
         myView = theView // this makes cyclic dependency, but it is OK for JVM
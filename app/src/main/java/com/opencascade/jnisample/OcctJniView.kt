@@ -30,6 +30,7 @@ import android.view.MotionEvent
 import android.widget.RelativeLayout
 import com.opencascade.jnisample.OcctJniLogger.postMessage
 import com.opencascade.jnisample.OcctJniRenderer.TypeOfOrientation
+import java.nio.ByteBuffer
 import javax.microedition.khronos.egl.EGL10
 import javax.microedition.khronos.egl.EGLConfig
 import javax.microedition.khronos.egl.EGLContext
@@ -45,6 +46,18 @@ internal class OcctJniView(theContext: Context,
         requestRender()
     }
 
+    //! Open file from file descriptor (closed afterwards).
+    fun openFd(theFd: Int, theName: String) {
+        queueEvent { myRenderer!!.openFd(theFd, theName) }
+        requestRender()
+    }
+
+    //! Open file from direct buffer.
+    fun openBuffer(theBuffer: ByteBuffer, theName: String) {
+        queueEvent { myRenderer!!.openBuffer(theBuffer, theName) }
+        requestRender()
+    }
+
     //! Create OpenGL ES 2.0+ context
     private class ContextFactory : EGLContextFactory {
         override fun createContext(theEgl: EGL10,
@@ -222,12 +235,36 @@ internal class OcctJniView(theContext: Context,
         requestRender()
     }
 
+    //! Switch picking mode
+    fun setGpuPicking(theToUseGpu: Boolean) {
+        queueEvent { myRenderer!!.setGpuPicking(theToUseGpu) }
+        requestRender()
+    }
+
+    //! Switch compact vertex format
+    fun setCompactVertices(theToUseCompact: Boolean) {
+        queueEvent { myRenderer!!.setCompactVertices(theToUseCompact) }
+        requestRender()
+    }
+
+    //! Switch occlusion culling
+    fun setOcclusionCulling(theToCull: Boolean) {
+        queueEvent { myRenderer!!.setOcclusionCulling(theToCull) }
+        requestRender()
+    }
+
     //! Move camera
     fun setProj(theProj: TypeOfOrientation?) {
         queueEvent { myRenderer!!.setProj(theProj) }
         requestRender()
     }
 
+    //! Set section plane
+    fun setSectionPlane(theAxis: Int, thePosition: Float) {
+        queueEvent { myRenderer!!.setSectionPlane(theAxis, thePosition) }
+        requestRender()
+    }
+
     //! OCCT viewer
     private var myRenderer: OcctJniRenderer? = null
     private val mySelectId = -1
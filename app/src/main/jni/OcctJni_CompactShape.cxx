@@ -0,0 +1,615 @@
+// Copyright (c) 2014-2021 OPEN CASCADE SAS
+//
+// This file is part of the examples of the Open CASCADE Technology software library.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
+
+#include "OcctJni_CompactShape.hxx"
+
+#include <Bnd_Box.hxx>
+#include <BRep_Tool.hxx>
+#include <Graphic3d_Group.hxx>
+#include <Graphic3d_ShaderProgram.hxx>
+#include <Message.hxx>
+#include <OpenGl_Context.hxx>
+#include <OpenGl_Element.hxx>
+#include <OpenGl_Group.hxx>
+#include <OpenGl_IndexBuffer.hxx>
+#include <OpenGl_ShaderManager.hxx>
+#include <OpenGl_VertexBuffer.hxx>
+#include <OpenGl_Workspace.hxx>
+#include <Precision.hxx>
+#include <Prs3d_ShadingAspect.hxx>
+#include <StdPrs_ToolTriangulatedShape.hxx>
+#include <NCollection_Sequence.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+  //! Number of 16-bit values per vertex: quantized position, padding and octahedral normal.
+  static const int THE_VERTEX_NB_VALUES = 6;
+
+  //! Vertex stride in bytes.
+  static const int THE_VERTEX_STRIDE = THE_VERTEX_NB_VALUES * sizeof(GLushort);
+
+  //! Size of simulated post-transform vertex cache.
+  static const int THE_VERTEX_CACHE_SIZE = 32;
+
+  //! Vertex shader decoding compact vertex.
+  static const char THE_VERT_SHADER[] =
+    "uniform vec3 uBoxMin;\n"
+    "uniform vec3 uBoxRange;\n"
+    "THE_SHADER_OUT vec3 Normal;\n"
+    "THE_SHADER_OUT vec4 PositionWorld;\n"
+    "float signNotZero (float theValue) { return theValue >= 0.0 ? 1.0 : -1.0; }\n"
+    "vec3 decodeOctahedral (vec2 theCode)\n"
+    "{\n"
+    "  vec2 anUV = theCode * 2.0 - 1.0;\n"
+    "  vec3 aDir = vec3 (anUV, 1.0 - abs (anUV.x) - abs (anUV.y));\n"
+    "  if (aDir.z < 0.0)\n"
+    "  {\n"
+    "    aDir.xy = vec2 ((1.0 - abs (anUV.y)) * signNotZero (anUV.x), (1.0 - abs (anUV.x)) * signNotZero (anUV.y));\n"
+    "  }\n"
+    "  return normalize (aDir);\n"
+    "}\n"
+    "void main()\n"
+    "{\n"
+    "  PositionWorld = occModelWorldMatrix * vec4 (uBoxMin + occVertex.xyz * uBoxRange, 1.0);\n"
+    "  Normal = normalize ((occWorldViewMatrix * occModelWorldMatrix * vec4 (decodeOctahedral (occNormal.xy), 0.0)).xyz);\n"
+    "  gl_Position = occProjectionMatrix * occWorldViewMatrix * PositionWorld;\n"
+    "}";
+
+  //! Fragment shader with two-sided headlight.
+  static const char THE_FRAG_SHADER[] =
+    "uniform vec4 uColor;\n"
+    "THE_SHADER_IN vec3 Normal;\n"
+    "THE_SHADER_IN vec4 PositionWorld;\n"
+    "void main()\n"
+    "{\n"
+    "#if defined(THE_MAX_CLIP_PLANES) && THE_MAX_CLIP_PLANES > 0\n"
+    "  for (int aPlaneIter = 0; aPlaneIter < THE_MAX_CLIP_PLANES; ++aPlaneIter)\n"
+    "  {\n"
+    "    if (aPlaneIter >= occClipPlaneCount) { break; }\n"
+    "    vec4 anEq = occClipPlaneEquations[aPlaneIter];\n"
+    "    if (dot (anEq.xyz, PositionWorld.xyz / PositionWorld.w) + anEq.w < 0.0) { discard; }\n"
+    "  }\n"
+    "#endif\n"
+    "  float aDiffuse = abs (normalize (Normal).z);\n"
+    "  occSetFragColor (vec4 (uColor.rgb * (0.3 + 0.7 * aDiffuse), uColor.a));\n"
+    "}";
+
+  //! Return program source shared by all presentations.
+  static const Handle(Graphic3d_ShaderProgram)& compactProgramSource()
+  {
+    static Handle(Graphic3d_ShaderProgram) THE_PROGRAM;
+    if (THE_PROGRAM.IsNull())
+    {
+      THE_PROGRAM = new Graphic3d_ShaderProgram();
+      THE_PROGRAM->SetNbLightsMax (0);
+      THE_PROGRAM->SetNbClipPlanesMax (4);
+      THE_PROGRAM->AttachShader (Graphic3d_ShaderObject::CreateFromSource (Graphic3d_TOS_VERTEX,   THE_VERT_SHADER));
+      THE_PROGRAM->AttachShader (Graphic3d_ShaderObject::CreateFromSource (Graphic3d_TOS_FRAGMENT, THE_FRAG_SHADER));
+    }
+    return THE_PROGRAM;
+  }
+
+  //! Vertex score for cache optimization (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation").
+  static float vertexCacheScore (const int theCachePos, const int theNbTrisLeft)
+  {
+    if (theNbTrisLeft == 0)
+    {
+      return -1.0f;
+    }
+
+    float aScore = 0.0f;
+    if (theCachePos >= 0)
+    {
+      // vertices of the last triangle are scored lower to avoid strip-like patterns
+      aScore = theCachePos < 3
+             ? 0.75f
+             : std::pow (1.0f - float(theCachePos - 3) / float(THE_VERTEX_CACHE_SIZE - 3), 1.5f);
+    }
+    // prefer vertices with few remaining triangles to finish them off
+    return aScore + 2.0f / std::sqrt (float(theNbTrisLeft));
+  }
+
+  //! Reorder triangles for post-transform vertex cache locality,
+  //! and then renumber vertices in order of their first use for pre-transform cache locality.
+  static void optimizeVertexCache (std::vector<GLuint>&   theIndices,
+                                   std::vector<GLushort>& theVerts)
+  {
+    const int aNbVerts = int(theVerts.size() / THE_VERTEX_NB_VALUES);
+    const int aNbTris  = int(theIndices.size() / 3);
+
+    // triangles adjacent to each vertex; the first aNbTrisLeft[] entries are not yet emitted
+    std::vector<int> aNbTrisLeft (aNbVerts, 0), aTrisOffset (aNbVerts + 1, 0), aVertTris (theIndices.size());
+    for (size_t anIndexIter = 0; anIndexIter < theIndices.size(); ++anIndexIter)
+    {
+      ++aNbTrisLeft[theIndices[anIndexIter]];
+    }
+    for (int aVertIter = 0; aVertIter < aNbVerts; ++aVertIter)
+    {
+      aTrisOffset[aVertIter + 1] = aTrisOffset[aVertIter] + aNbTrisLeft[aVertIter];
+    }
+    {
+      std::vector<int> aFillPos (aTrisOffset.begin(), aTrisOffset.end() - 1);
+      for (size_t anIndexIter = 0; anIndexIter < theIndices.size(); ++anIndexIter)
+      {
+        aVertTris[aFillPos[theIndices[anIndexIter]]++] = int(anIndexIter / 3);
+      }
+    }
+
+    std::vector<int>   aCachePos (aNbVerts, -1);
+    std::vector<float> aVertScore (aNbVerts, 0.0f);
+    for (int aVertIter = 0; aVertIter < aNbVerts; ++aVertIter)
+    {
+      aVertScore[aVertIter] = vertexCacheScore (-1, aNbTrisLeft[aVertIter]);
+    }
+
+    std::vector<float> aTriScore (aNbTris, 0.0f);
+    std::vector<bool>  isTriAdded (aNbTris, false);
+    int aBestTri = -1;
+    for (int aTriIter = 0; aTriIter < aNbTris; ++aTriIter)
+    {
+      aTriScore[aTriIter] = aVertScore[theIndices[aTriIter * 3 + 0]]
+                          + aVertScore[theIndices[aTriIter * 3 + 1]]
+                          + aVertScore[theIndices[aTriIter * 3 + 2]];
+      if (aBestTri == -1
+       || aTriScore[aTriIter] > aTriScore[aBestTri])
+      {
+        aBestTri = aTriIter;
+      }
+    }
+
+    std::vector<GLuint> aResult;
+    aResult.reserve (theIndices.size());
+    int aCache[THE_VERTEX_CACHE_SIZE + 3];
+    int aCacheSize = 0;
+    int aScanPos = 0;
+    while (aBestTri >= 0)
+    {
+      isTriAdded[aBestTri] = true;
+      int aNewCache[THE_VERTEX_CACHE_SIZE + 3];
+      int aNewCacheSize = 0;
+      for (int aCornerIter = 0; aCornerIter < 3; ++aCornerIter)
+      {
+        const int aVert = (int )theIndices[aBestTri * 3 + aCornerIter];
+        aResult.push_back ((GLuint )aVert);
+        aNewCache[aNewCacheSize++] = aVert;
+
+        // remove emitted triangle from the list of remaining ones
+        int* aTris = &aVertTris[aTrisOffset[aVert]];
+        int& aNbLeft = aNbTrisLeft[aVert];
+        for (int aTriIter = 0; aTriIter < aNbLeft; ++aTriIter)
+        {
+          if (aTris[aTriIter] == aBestTri)
+          {
+            std::swap (aTris[aTriIter], aTris[aNbLeft - 1]);
+            --aNbLeft;
+            break;
+          }
+        }
+      }
+      for (int aCacheIter = 0; aCacheIter < aCacheSize; ++aCacheIter)
+      {
+        const int aVert = aCache[aCacheIter];
+        if (aVert != aNewCache[0]
+         && aVert != aNewCache[1]
+         && aVert != aNewCache[2])
+        {
+          aNewCache[aNewCacheSize++] = aVert;
+        }
+      }
+
+      // update scores of vertices in cache (including evicted ones) and their triangles
+      for (int aCacheIter = 0; aCacheIter < aNewCacheSize; ++aCacheIter)
+      {
+        const int aVert = aNewCache[aCacheIter];
+        aCachePos[aVert]  = aCacheIter < THE_VERTEX_CACHE_SIZE ? aCacheIter : -1;
+        aVertScore[aVert] = vertexCacheScore (aCachePos[aVert], aNbTrisLeft[aVert]);
+      }
+      aBestTri = -1;
+      float aBestScore = -1.0f;
+      for (int aCacheIter = 0; aCacheIter < aNewCacheSize; ++aCacheIter)
+      {
+        const int aVert = aNewCache[aCacheIter];
+        for (int aTriIter = 0; aTriIter < aNbTrisLeft[aVert]; ++aTriIter)
+        {
+          const int aTri = aVertTris[aTrisOffset[aVert] + aTriIter];
+          aTriScore[aTri] = aVertScore[theIndices[aTri * 3 + 0]]
+                          + aVertScore[theIndices[aTri * 3 + 1]]
+                          + aVertScore[theIndices[aTri * 3 + 2]];
+          if (aTriScore[aTri] > aBestScore)
+          {
+            aBestScore = aTriScore[aTri];
+            aBestTri   = aTri;
+          }
+        }
+      }
+
+      aCacheSize = std::min (aNewCacheSize, THE_VERTEX_CACHE_SIZE);
+      std::copy (aNewCache, aNewCache + aCacheSize, aCache);
+      if (aBestTri < 0)
+      {
+        // cache has no connected triangles - continue from the next not emitted one
+        for (; aScanPos < aNbTris && isTriAdded[aScanPos]; ++aScanPos) {}
+        aBestTri = aScanPos < aNbTris ? aScanPos : -1;
+      }
+    }
+
+    // renumber vertices in order of first use
+    std::vector<GLuint>   aRemap (aNbVerts, GLuint(-1));
+    std::vector<GLushort> aVerts (theVerts.size());
+    GLuint aNbUsed = 0;
+    for (size_t anIndexIter = 0; anIndexIter < aResult.size(); ++anIndexIter)
+    {
+      GLuint& aNewIndex = aRemap[aResult[anIndexIter]];
+      if (aNewIndex == GLuint(-1))
+      {
+        aNewIndex = aNbUsed++;
+        std::copy (theVerts.begin() + aResult[anIndexIter] * THE_VERTEX_NB_VALUES,
+                   theVerts.begin() + (aResult[anIndexIter] + 1) * THE_VERTEX_NB_VALUES,
+                   aVerts.begin() + aNewIndex * THE_VERTEX_NB_VALUES);
+      }
+      aResult[anIndexIter] = aNewIndex;
+    }
+    aVerts.resize (aNbUsed * THE_VERTEX_NB_VALUES);
+    theIndices.swap (aResult);
+    theVerts.swap (aVerts);
+  }
+
+  //! Return TRUE if 16-bit indices are used for specified number of vertices (the same rule as for OCCT primitive arrays).
+  static bool isShortIndex (const size_t theNbVerts)
+  {
+    return theNbVerts < 65536;
+  }
+
+  //! Quantize value within [0, 1] range to 16 bits.
+  static GLushort quantizeUnorm16 (const double theValue)
+  {
+    return (GLushort )(std::min (std::max (theValue, 0.0), 1.0) * 65535.0 + 0.5);
+  }
+
+  //! Encode unit vector into octahedral coordinates within [0, 1] range.
+  static void encodeOctahedral (const gp_Dir& theDir, double& theU, double& theV)
+  {
+    const double aNorm1 = std::abs (theDir.X()) + std::abs (theDir.Y()) + std::abs (theDir.Z());
+    theU = theDir.X() / aNorm1;
+    theV = theDir.Y() / aNorm1;
+    if (theDir.Z() < 0.0)
+    {
+      const double anU = theU;
+      theU = (1.0 - std::abs (theV)) * (anU  >= 0.0 ? 1.0 : -1.0);
+      theV = (1.0 - std::abs (anU))  * (theV >= 0.0 ? 1.0 : -1.0);
+    }
+    theU = theU * 0.5 + 0.5;
+    theV = theV * 0.5 + 0.5;
+  }
+}
+
+//! OpenGL element drawing triangles in compact vertex format.
+class OcctJni_CompactTriangles : public OpenGl_Element
+{
+public:
+
+  //! Main constructor taking ownership over vertex and index data.
+  OcctJni_CompactTriangles (std::vector<GLushort>& theVerts,
+                            std::vector<GLuint>&   theIndices,
+                            const OpenGl_Vec3&     theBoxMin,
+                            const OpenGl_Vec3&     theBoxRange)
+  : myBoxMin (theBoxMin),
+    myBoxRange (theBoxRange),
+    myNbIndices ((GLsizei )theIndices.size()),
+    myGpuDataSize (0),
+    myIsInitFailed (false)
+  {
+    myVerts.swap (theVerts);
+    myIndices.swap (theIndices);
+  }
+
+  //! Render triangles.
+  virtual void Render (const Handle(OpenGl_Workspace)& theWorkspace) const override
+  {
+    const Handle(OpenGl_Context)& aCtx = theWorkspace->GetGlContext();
+    // face culling (from the aspect or the view backfacing model) and polygon offset of the aspect
+    // are applied to the context here, the same way as for OpenGl_PrimitiveArray
+    const OpenGl_Aspects* anAspect = theWorkspace->ApplyAspects();
+    if (!initGlResources (aCtx))
+    {
+      return;
+    }
+
+    const Quantity_ColorRGBA& aColor = !theWorkspace->HighlightStyle().IsNull()
+                                     ? theWorkspace->HighlightStyle()->ColorRGBA()
+                                     : anAspect->Aspect()->InteriorColorRGBA();
+    aCtx->BindProgram (myProgram);
+    aCtx->ShaderManager()->PushState (myProgram);
+    myProgram->SetUniform (aCtx, "uBoxMin",   myBoxMin);
+    myProgram->SetUniform (aCtx, "uBoxRange", myBoxRange);
+    myProgram->SetUniform (aCtx, "uColor",    aCtx->Vec4FromQuantityColor (aColor));
+
+    myVbo->Bind (aCtx);
+    aCtx->core20fwd->glEnableVertexAttribArray (Graphic3d_TOA_POS);
+    aCtx->core20fwd->glEnableVertexAttribArray (Graphic3d_TOA_NORM);
+    aCtx->core20fwd->glVertexAttribPointer (Graphic3d_TOA_POS,  3, GL_UNSIGNED_SHORT, GL_TRUE, THE_VERTEX_STRIDE, NULL);
+    aCtx->core20fwd->glVertexAttribPointer (Graphic3d_TOA_NORM, 2, GL_UNSIGNED_SHORT, GL_TRUE, THE_VERTEX_STRIDE, (const GLvoid* )(4 * sizeof(GLushort)));
+    myIbo->Bind (aCtx);
+    aCtx->core20fwd->glDrawElements (GL_TRIANGLES, myNbIndices, myIbo->GetDataType(), NULL);
+    myIbo->Unbind (aCtx);
+    aCtx->core20fwd->glDisableVertexAttribArray (Graphic3d_TOA_POS);
+    aCtx->core20fwd->glDisableVertexAttribArray (Graphic3d_TOA_NORM);
+    myVbo->Unbind (aCtx);
+  }
+
+  //! Release OpenGL resources.
+  virtual void Release (OpenGl_Context* theCtx) override
+  {
+    if (!myVbo.IsNull())
+    {
+      myVbo->Release (theCtx);
+      myVbo.Nullify();
+    }
+    if (!myIbo.IsNull())
+    {
+      myIbo->Release (theCtx);
+      myIbo.Nullify();
+    }
+    if (!myProgram.IsNull()
+      && theCtx != NULL)
+    {
+      theCtx->ShaderManager()->Unregister (myProgramKey, myProgram);
+    }
+    myProgram.Nullify();
+    myGpuDataSize = 0;
+  }
+
+  //! Element is drawn in filled mode (also by capping algorithm).
+  virtual Standard_Boolean IsFillDrawMode() const override { return Standard_True; }
+
+  //! Update GPU memory statistics.
+  virtual void UpdateMemStats (Graphic3d_FrameStatsDataTmp& theStats) const override
+  {
+    theStats[Graphic3d_FrameStatsCounter_EstimatedBytesGeom] += myGpuDataSize;
+  }
+
+  //! Update drawing statistics.
+  virtual void UpdateDrawStats (Graphic3d_FrameStatsDataTmp& theStats,
+                                bool theIsDetailed) const override
+  {
+    (void )theIsDetailed;
+    ++theStats[Graphic3d_FrameStatsCounter_NbElemsNotCulled];
+    ++theStats[Graphic3d_FrameStatsCounter_NbElemsFillNotCulled];
+    theStats[Graphic3d_FrameStatsCounter_NbTrianglesNotCulled] += myNbIndices / 3;
+  }
+
+private:
+
+  //! Upload data to GPU on first use and release CPU copy.
+  bool initGlResources (const Handle(OpenGl_Context)& theCtx) const
+  {
+    if (!myVbo.IsNull()
+     || myIsInitFailed)
+    {
+      return !myIsInitFailed;
+    }
+
+    myIsInitFailed = true;
+    const size_t aNbVerts = myVerts.size() / THE_VERTEX_NB_VALUES;
+    const bool toUseShortIndex = isShortIndex (aNbVerts);
+    if (!toUseShortIndex
+     && !theCtx->IsGlGreaterEqual (3, 0)
+     && !theCtx->CheckExtension ("GL_OES_element_index_uint"))
+    {
+      Message::SendFail ("Error: compact presentation has too many vertices for 16-bit indices");
+      return false;
+    }
+    if (!theCtx->ShaderManager()->Create (compactProgramSource(), myProgramKey, myProgram))
+    {
+      Message::SendFail ("Error: compact vertex program can not be created");
+      return false;
+    }
+
+    myVbo = new OpenGl_VertexBuffer();
+    myIbo = new OpenGl_IndexBuffer();
+    bool isDone = myVbo->Init (theCtx, 1, (GLsizei )myVerts.size(), &myVerts.front());
+    if (toUseShortIndex)
+    {
+      std::vector<GLushort> aShortIndices (myIndices.begin(), myIndices.end());
+      isDone = isDone && myIbo->Init (theCtx, 1, myNbIndices, &aShortIndices.front());
+    }
+    else
+    {
+      isDone = isDone && myIbo->Init (theCtx, 1, myNbIndices, &myIndices.front());
+    }
+    if (!isDone)
+    {
+      Message::SendFail ("Error: compact vertex data can not be uploaded");
+      return false;
+    }
+
+    myGpuDataSize = myVerts.size() * sizeof(GLushort) + myIndices.size() * (toUseShortIndex ? sizeof(GLushort) : sizeof(GLuint));
+    std::vector<GLushort>().swap (myVerts);
+    std::vector<GLuint>().swap (myIndices);
+    myIsInitFailed = false;
+    return true;
+  }
+
+private:
+
+  mutable std::vector<GLushort>        myVerts;        //!< vertex data before upload
+  mutable std::vector<GLuint>          myIndices;      //!< index data before upload
+  mutable Handle(OpenGl_VertexBuffer)  myVbo;          //!< vertex buffer
+  mutable Handle(OpenGl_IndexBuffer)   myIbo;          //!< index buffer
+  mutable Handle(OpenGl_ShaderProgram) myProgram;      //!< decoding program
+  mutable TCollection_AsciiString      myProgramKey;   //!< program sharing key
+  OpenGl_Vec3                          myBoxMin;       //!< quantization box origin
+  OpenGl_Vec3                          myBoxRange;     //!< quantization box dimensions
+  GLsizei                              myNbIndices;    //!< number of indices
+  mutable Standard_Size                myGpuDataSize;  //!< size of uploaded data
+  mutable bool                         myIsInitFailed; //!< resources can not be initialized
+
+};
+
+// =======================================================================
+// function : Compute
+// purpose  :
+// =======================================================================
+void OcctJni_CompactShape::Compute (const Handle(PrsMgr_PresentationManager)& thePrsMgr,
+                                    const Handle(Prs3d_Presentation)& thePrs,
+                                    const Standard_Integer theMode)
+{
+  if (theMode != AIS_Shaded)
+  {
+    AIS_Shape::Compute (thePrsMgr, thePrs, theMode);
+    return;
+  }
+
+  StdPrs_ToolTriangulatedShape::Tessellate (myshape, myDrawer);
+
+  // each solid, free shell and free face is quantized within its own bounding box
+  NCollection_Sequence<TopoDS_Shape> aParts;
+  for (TopExp_Explorer aSolidIter (myshape, TopAbs_SOLID); aSolidIter.More(); aSolidIter.Next())
+  {
+    aParts.Append (aSolidIter.Current());
+  }
+  for (TopExp_Explorer aShellIter (myshape, TopAbs_SHELL, TopAbs_SOLID); aShellIter.More(); aShellIter.Next())
+  {
+    aParts.Append (aShellIter.Current());
+  }
+  for (TopExp_Explorer aFaceIter (myshape, TopAbs_FACE, TopAbs_SHELL); aFaceIter.More(); aFaceIter.Next())
+  {
+    aParts.Append (aFaceIter.Current());
+  }
+
+  myCompactDataSize = 0;
+  myFloatDataSize   = 0;
+  bool hasTriangles = false;
+  for (NCollection_Sequence<TopoDS_Shape>::Iterator aPartIter (aParts); aPartIter.More(); aPartIter.Next())
+  {
+    hasTriangles = addPart (thePrs, aPartIter.Value()) || hasTriangles;
+  }
+  if (!hasTriangles)
+  {
+    // free edges and vertices only
+    AIS_Shape::Compute (thePrsMgr, thePrs, theMode);
+  }
+}
+
+// =======================================================================
+// function : addPart
+// purpose  :
+// =======================================================================
+bool OcctJni_CompactShape::addPart (const Handle(Prs3d_Presentation)& thePrs,
+                                    const TopoDS_Shape& thePart)
+{
+  // collect nodes and normals of all faces
+  std::vector<gp_Pnt> aNodes;
+  std::vector<gp_Dir> aNormals;
+  std::vector<GLuint> anIndices;
+  Bnd_Box aBox;
+  for (TopExp_Explorer aFaceIter (thePart, TopAbs_FACE); aFaceIter.More(); aFaceIter.Next())
+  {
+    const TopoDS_Face& aFace = TopoDS::Face (aFaceIter.Current());
+    TopLoc_Location aLoc;
+    const Handle(Poly_Triangulation)& aTris = BRep_Tool::Triangulation (aFace, aLoc);
+    if (aTris.IsNull())
+    {
+      continue;
+    }
+
+    StdPrs_ToolTriangulatedShape::ComputeNormals (aFace, aTris);
+    const gp_Trsf aTrsf = aLoc.Transformation();
+    const bool isReversed = aFace.Orientation() == TopAbs_REVERSED;
+    const bool isMirrored = aTrsf.VectorialPart().Determinant() < 0.0;
+    const GLuint aFirstNode = (GLuint )aNodes.size();
+    for (Standard_Integer aNodeIter = 1; aNodeIter <= aTris->NbNodes(); ++aNodeIter)
+    {
+      const gp_Pnt aNode = aTris->Node (aNodeIter).Transformed (aTrsf);
+      gp_Dir aNormal = aTris->Normal (aNodeIter).Transformed (aTrsf);
+      if (isReversed)
+      {
+        aNormal.Reverse();
+      }
+      aNodes.push_back (aNode);
+      aNormals.push_back (aNormal);
+      aBox.Add (aNode);
+    }
+    for (Standard_Integer aTriIter = 1; aTriIter <= aTris->NbTriangles(); ++aTriIter)
+    {
+      Standard_Integer aNodeIds[3];
+      aTris->Triangle (aTriIter).Get (aNodeIds[0], aNodeIds[1], aNodeIds[2]);
+      if (isReversed != isMirrored)
+      {
+        std::swap (aNodeIds[1], aNodeIds[2]);
+      }
+      for (int aCornerIter = 0; aCornerIter < 3; ++aCornerIter)
+      {
+        anIndices.push_back (aFirstNode + GLuint(aNodeIds[aCornerIter] - 1));
+      }
+    }
+  }
+  if (anIndices.empty())
+  {
+    return false;
+  }
+
+  // quantize positions within bounding box and encode normals
+  const gp_XYZ aBoxMin = aBox.CornerMin().XYZ();
+  gp_XYZ aBoxRange = aBox.CornerMax().XYZ() - aBoxMin;
+  for (int aCoordIter = 1; aCoordIter <= 3; ++aCoordIter)
+  {
+    aBoxRange.SetCoord (aCoordIter, std::max (aBoxRange.Coord (aCoordIter), Precision::Confusion()));
+  }
+  std::vector<GLushort> aVerts (aNodes.size() * THE_VERTEX_NB_VALUES, 0);
+  for (size_t aNodeIter = 0; aNodeIter < aNodes.size(); ++aNodeIter)
+  {
+    GLushort* aVert = &aVerts[aNodeIter * THE_VERTEX_NB_VALUES];
+    const gp_XYZ aPos = aNodes[aNodeIter].XYZ() - aBoxMin;
+    aVert[0] = quantizeUnorm16 (aPos.X() / aBoxRange.X());
+    aVert[1] = quantizeUnorm16 (aPos.Y() / aBoxRange.Y());
+    aVert[2] = quantizeUnorm16 (aPos.Z() / aBoxRange.Z());
+    double anOctU = 0.0, anOctV = 0.0;
+    encodeOctahedral (aNormals[aNodeIter], anOctU, anOctV);
+    aVert[4] = quantizeUnorm16 (anOctU);
+    aVert[5] = quantizeUnorm16 (anOctV);
+  }
+  std::vector<gp_Pnt>().swap (aNodes);
+  std::vector<gp_Dir>().swap (aNormals);
+
+  optimizeVertexCache (anIndices, aVerts);
+
+  // the same index width rule is applied to both formats
+  const size_t aNbVerts = aVerts.size() / THE_VERTEX_NB_VALUES;
+  const size_t anIndexSize = isShortIndex (aNbVerts) ? sizeof(GLushort) : sizeof(GLuint);
+  myFloatDataSize   += aNbVerts * 6 * sizeof(float) + anIndices.size() * anIndexSize;
+  myCompactDataSize += aVerts.size() * sizeof(GLushort) + anIndices.size() * anIndexSize;
+
+  Handle(Graphic3d_Group) aGroup = thePrs->NewGroup();
+  aGroup->SetGroupPrimitivesAspect (myDrawer->ShadingAspect()->Aspect());
+  aGroup->SetMinMaxValues (aBox.CornerMin().X(), aBox.CornerMin().Y(), aBox.CornerMin().Z(),
+                           aBox.CornerMax().X(), aBox.CornerMax().Y(), aBox.CornerMax().Z());
+  Handle(OpenGl_Group)::DownCast (aGroup)->AddElement (new OcctJni_CompactTriangles (aVerts, anIndices,
+    OpenGl_Vec3 ((float )aBoxMin.X(),   (float )aBoxMin.Y(),   (float )aBoxMin.Z()),
+    OpenGl_Vec3 ((float )aBoxRange.X(), (float )aBoxRange.Y(), (float )aBoxRange.Z())));
+  return true;
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2014-2021 OPEN CASCADE SAS
+//
+// This file is part of the examples of the Open CASCADE Technology software library.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
+
+#ifndef OcctJni_CompactShape_H
+#define OcctJni_CompactShape_H
+
+#include <AIS_Shape.hxx>
+
+//! Shape presentation with compact vertex format for shaded mode.
+//! Positions are quantized to 16 bits within bounding box of each part (solid, free shell or free face)
+//! and normals are octahedral-encoded into two 16-bit values, decoded in the vertex shader;
+//! this halves vertex data size comparing to 32-bit float positions and normals.
+//! Triangles are reordered for post-transform vertex cache locality.
+//! Other display modes are computed by AIS_Shape.
+class OcctJni_CompactShape : public AIS_Shape
+{
+  DEFINE_STANDARD_RTTI_INLINE(OcctJni_CompactShape, AIS_Shape)
+public:
+
+  //! Main constructor.
+  OcctJni_CompactShape (const TopoDS_Shape& theShape)
+  : AIS_Shape (theShape),
+    myCompactDataSize (0),
+    myFloatDataSize (0) {}
+
+  //! Return size of compact vertex and index data in bytes of the last computed shaded presentation.
+  Standard_Size CompactDataSize() const { return myCompactDataSize; }
+
+  //! Return size of the same data in 32-bit float vertex format with the same index width.
+  Standard_Size FloatDataSize() const { return myFloatDataSize; }
+
+protected:
+
+  //! Compute presentation.
+  virtual void Compute (const Handle(PrsMgr_PresentationManager)& thePrsMgr,
+                        const Handle(Prs3d_Presentation)& thePrs,
+                        const Standard_Integer theMode) override;
+
+  //! Add compact triangles of the part into presentation.
+  //! @return FALSE if the part has no triangulation
+  bool addPart (const Handle(Prs3d_Presentation)& thePrs,
+                const TopoDS_Shape& thePart);
+
+private:
+
+  Standard_Size myCompactDataSize; //!< size of compact data
+  Standard_Size myFloatDataSize;   //!< size of data in float format
+
+};
+
+#endif // OcctJni_CompactShape_H
@@ -0,0 +1,300 @@
+// Copyright (c) 2014-2021 OPEN CASCADE SAS
+//
+// This file is part of the examples of the Open CASCADE Technology software library.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
+
+#include "OcctJni_IdPicker.hxx"
+
+#include <Aspect_NeutralWindow.hxx>
+#include <Graphic3d_CameraTile.hxx>
+#include <Message.hxx>
+#include <OpenGl_Group.hxx>
+#include <OpenGl_PrimitiveArray.hxx>
+#include <Prs3d_IsoAspect.hxx>
+#include <TopExp.hxx>
+
+#include <EGL/egl.h>
+
+namespace
+{
+  //! Number of significant bits per color channel encoding ID;
+  //! lower bits are reserved to tolerate color conversion errors.
+  static const int THE_ID_BITS = 6;
+
+  //! Maximum ID which can be encoded.
+  static const int THE_ID_MAX = (1 << (THE_ID_BITS * 3)) - 1;
+
+  //! Encode ID into color.
+  static Quantity_Color idToColor (int theId)
+  {
+    const int aMask  = (1 << THE_ID_BITS) - 1;
+    const int aShift = 8 - THE_ID_BITS;
+    const int aHalf  = 1 << (aShift - 1);
+    const int aRed   = ((theId >> (THE_ID_BITS * 2)) & aMask) << aShift;
+    const int aGreen = ((theId >>  THE_ID_BITS)      & aMask) << aShift;
+    const int aBlue  = ( theId                       & aMask) << aShift;
+    return Quantity_Color ((aRed   + aHalf) / 255.0,
+                           (aGreen + aHalf) / 255.0,
+                           (aBlue  + aHalf) / 255.0, Quantity_TOC_sRGB);
+  }
+
+  //! Return estimated size of primitive arrays within presentation.
+  static Standard_Size estimatedPrsSize (const Handle(AIS_InteractiveObject)& thePrs)
+  {
+    Standard_Size aSize = 0;
+    if (thePrs.IsNull())
+    {
+      return aSize;
+    }
+
+    for (PrsMgr_Presentations::Iterator aPrsIter (thePrs->Presentations()); aPrsIter.More(); aPrsIter.Next())
+    {
+      for (Graphic3d_SequenceOfGroup::Iterator aGroupIter (aPrsIter.Value()->Groups()); aGroupIter.More(); aGroupIter.Next())
+      {
+        Handle(OpenGl_Group) aGroup = Handle(OpenGl_Group)::DownCast (aGroupIter.Value());
+        if (aGroup.IsNull())
+        {
+          continue;
+        }
+
+        for (const OpenGl_ElementNode* aNode = aGroup->FirstNode(); aNode != NULL; aNode = aNode->next)
+        {
+          const OpenGl_PrimitiveArray* anArray = dynamic_cast<const OpenGl_PrimitiveArray*> (aNode->elem);
+          if (anArray == NULL)
+          {
+            continue;
+          }
+
+          if (anArray->EstimatedDataSize() != 0)
+          {
+            // already uploaded to GPU
+            aSize += anArray->EstimatedDataSize();
+            continue;
+          }
+          if (!anArray->Attributes().IsNull())
+          {
+            aSize += anArray->Attributes()->Size();
+          }
+          if (!anArray->Indices().IsNull())
+          {
+            aSize += anArray->Indices()->Size();
+          }
+        }
+      }
+    }
+    return aSize;
+  }
+
+  //! Decode ID from color.
+  static int colorToId (const Image_ColorRGBA& theColor)
+  {
+    const int aShift = 8 - THE_ID_BITS;
+    return ((theColor.r() >> aShift) << (THE_ID_BITS * 2))
+         | ((theColor.g() >> aShift) <<  THE_ID_BITS)
+         |  (theColor.b() >> aShift);
+  }
+}
+
+// =======================================================================
+// function : OcctJni_IdPicker
+// purpose  :
+// =======================================================================
+OcctJni_IdPicker::OcctJni_IdPicker()
+{
+  //
+}
+
+// =======================================================================
+// function : Init
+// purpose  :
+// =======================================================================
+bool OcctJni_IdPicker::Init (const Handle(V3d_Viewer)& theViewer)
+{
+  if (theViewer.IsNull())
+  {
+    return false;
+  }
+
+  if (myViewer.IsNull())
+  {
+    // dedicated viewer keeps ID presentation out of the main view
+    myViewer = new V3d_Viewer (theViewer->Driver());
+    myViewer->SetDefaultBackgroundColor (Quantity_NOC_BLACK);
+    myContext = new AIS_InteractiveContext (myViewer);
+    myContext->SetAutoActivateSelection (false);
+
+    myView = myViewer->CreateView();
+    myView->SetImmediateUpdate (false);
+    myView->SetShadingModel (Graphic3d_TOSM_UNLIT);
+    if (!myIdPrs.IsNull())
+    {
+      myContext->Display (myIdPrs,     AIS_Shaded,    -1, Standard_False);
+      myContext->Display (myEdgeIdPrs, AIS_WireFrame, -1, Standard_False);
+    }
+  }
+
+  Handle(Aspect_NeutralWindow) aWindow = Handle(Aspect_NeutralWindow)::DownCast (myView->Window());
+  if (aWindow.IsNull())
+  {
+    aWindow = new Aspect_NeutralWindow();
+    aWindow->SetSize (1, 1);
+  }
+  // the view is never redrawn into the window - only into offscreen buffer by ToPixMap()
+  myView->SetWindow (aWindow, (Aspect_RenderingContext )eglGetCurrentContext());
+  return true;
+}
+
+// =======================================================================
+// function : Release
+// purpose  :
+// =======================================================================
+void OcctJni_IdPicker::Release()
+{
+  myContext.Nullify();
+  myView.Nullify();
+  myViewer.Nullify();
+}
+
+// =======================================================================
+// function : SetShape
+// purpose  :
+// =======================================================================
+void OcctJni_IdPicker::SetShape (const TopoDS_Shape& theShape)
+{
+  if (!myContext.IsNull()
+   && !myIdPrs.IsNull())
+  {
+    myContext->Remove (myIdPrs,     Standard_False);
+    myContext->Remove (myEdgeIdPrs, Standard_False);
+  }
+  myIdPrs.Nullify();
+  myEdgeIdPrs.Nullify();
+  myFaces.Clear();
+  myEdges.Clear();
+  if (theShape.IsNull())
+  {
+    return;
+  }
+
+  TopExp::MapShapes (theShape, TopAbs_FACE, myFaces);
+  TopExp::MapShapes (theShape, TopAbs_EDGE, myEdges);
+  const int aNbIds = myFaces.Extent() + myEdges.Extent();
+  if (aNbIds > THE_ID_MAX)
+  {
+    Message::SendWarning (TCollection_AsciiString() + "Warning: only " + THE_ID_MAX + " faces and edges out of " + aNbIds + " can be picked on GPU");
+  }
+
+  myIdPrs = new AIS_ColoredShape (theShape);
+  myIdPrs->SetColor (Quantity_NOC_BLACK);
+  for (int aFaceIter = 1; aFaceIter <= myFaces.Extent() && aFaceIter <= THE_ID_MAX; ++aFaceIter)
+  {
+    myIdPrs->SetCustomColor (myFaces.FindKey (aFaceIter), idToColor (aFaceIter));
+  }
+
+  // edges are drawn as thick lines over faces, which are shifted back by default polygon offset
+  myEdgeIdPrs = new AIS_ColoredShape (theShape);
+  myEdgeIdPrs->SetColor (Quantity_NOC_BLACK);
+  myEdgeIdPrs->SetWidth (3.0);
+  myEdgeIdPrs->Attributes()->SetUIsoAspect (new Prs3d_IsoAspect (Quantity_NOC_BLACK, Aspect_TOL_SOLID, 1.0, 0));
+  myEdgeIdPrs->Attributes()->SetVIsoAspect (new Prs3d_IsoAspect (Quantity_NOC_BLACK, Aspect_TOL_SOLID, 1.0, 0));
+  for (int anEdgeIter = 1; anEdgeIter <= myEdges.Extent() && myFaces.Extent() + anEdgeIter <= THE_ID_MAX; ++anEdgeIter)
+  {
+    myEdgeIdPrs->SetCustomColor (myEdges.FindKey (anEdgeIter), idToColor (myFaces.Extent() + anEdgeIter));
+  }
+  if (!myContext.IsNull())
+  {
+    myContext->Display (myIdPrs,     AIS_Shaded,    -1, Standard_False);
+    myContext->Display (myEdgeIdPrs, AIS_WireFrame, -1, Standard_False);
+  }
+}
+
+// =======================================================================
+// function : EstimatedDataSize
+// purpose  :
+// =======================================================================
+Standard_Size OcctJni_IdPicker::EstimatedDataSize() const
+{
+  return estimatedPrsSize (myIdPrs)
+       + estimatedPrsSize (myEdgeIdPrs);
+}
+
+// =======================================================================
+// function : Pick
+// purpose  :
+// =======================================================================
+int OcctJni_IdPicker::Pick (const Handle(V3d_View)& theView,
+                            const Graphic3d_Vec2i&  thePnt,
+                            int theTolerance)
+{
+  if (myView.IsNull()
+   || myIdPrs.IsNull()
+   || theView.IsNull())
+  {
+    return 0;
+  }
+
+  Graphic3d_Vec2i aViewSize;
+  theView->Window()->Size (aViewSize.x(), aViewSize.y());
+  const int aTileSize = 2 * theTolerance + 1;
+  Handle(Aspect_NeutralWindow) aWindow = Handle(Aspect_NeutralWindow)::DownCast (myView->Window());
+  if (aWindow->SetSize (aTileSize, aTileSize))
+  {
+    myView->MustBeResized();
+  }
+
+  // render only the small tile of the view around picked point
+  Graphic3d_CameraTile aTile;
+  aTile.TotalSize = aViewSize;
+  aTile.TileSize  = Graphic3d_Vec2i (aTileSize, aTileSize);
+  aTile.Offset    = thePnt - Graphic3d_Vec2i (theTolerance, theTolerance);
+  aTile.IsTopDown = true;
+  myView->Camera()->Copy (theView->Camera());
+  myView->Camera()->SetTile (aTile);
+
+  V3d_ImageDumpOptions aDumpParams;
+  aDumpParams.Width  = aTileSize;
+  aDumpParams.Height = aTileSize;
+  aDumpParams.BufferType     = Graphic3d_BT_RGBA;
+  aDumpParams.ToAdjustAspect = false;
+  if (!myImage.InitZero (Image_Format_RGBA, aTileSize, aTileSize)
+   || !myView->ToPixMap (myImage, aDumpParams))
+  {
+    Message::SendFail ("Error: ID buffer can not be rendered");
+    return 0;
+  }
+
+  // find the picked pixel nearest to the center
+  int aBestId = 0, aBestDist = IntegerLast();
+  for (int aRow = 0; aRow < aTileSize; ++aRow)
+  {
+    for (int aCol = 0; aCol < aTileSize; ++aCol)
+    {
+      const int anId = colorToId (myImage.Value<Image_ColorRGBA> (aRow, aCol));
+      const int aDist = (aRow - theTolerance) * (aRow - theTolerance) + (aCol - theTolerance) * (aCol - theTolerance);
+      if (anId > 0
+       && anId <= myFaces.Extent() + myEdges.Extent()
+       && aDist < aBestDist)
+      {
+        aBestId   = anId;
+        aBestDist = aDist;
+      }
+    }
+  }
+  return aBestId;
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2014-2021 OPEN CASCADE SAS
+//
+// This file is part of the examples of the Open CASCADE Technology software library.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
+
+#ifndef OcctJni_IdPicker_H
+#define OcctJni_IdPicker_H
+
+#include <AIS_ColoredShape.hxx>
+#include <AIS_InteractiveContext.hxx>
+#include <Image_PixMap.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <V3d_View.hxx>
+#include <V3d_Viewer.hxx>
+
+//! GPU picking tool rendering face and edge IDs as unlit colors into offscreen buffer
+//! and reading back pixels around the picked point.
+//! Faces are numbered first (1..NbFaces()), followed by edges.
+//! Unlike selection within AIS_InteractiveContext, it does not require sensitive entities and BVH trees,
+//! but duplicates presentation of the shape in a dedicated viewer sharing graphic driver of the main viewer.
+class OcctJni_IdPicker
+{
+public:
+
+  //! Empty constructor.
+  OcctJni_IdPicker();
+
+  //! Initialize picking viewer sharing graphic driver with specified viewer.
+  //! Should be called from rendering thread.
+  bool Init (const Handle(V3d_Viewer)& theViewer);
+
+  //! Release picking viewer.
+  void Release();
+
+  //! Set shape to be picked and compute ID presentation.
+  void SetShape (const TopoDS_Shape& theShape);
+
+  //! Return the number of pickable faces.
+  int NbFaces() const { return myFaces.Extent(); }
+
+  //! Return the number of pickable edges.
+  int NbEdges() const { return myEdges.Extent(); }
+
+  //! Return presentation with per-face ID colors.
+  const Handle(AIS_ColoredShape)& Presentation() const { return myIdPrs; }
+
+  //! Return presentation with per-edge ID colors.
+  const Handle(AIS_ColoredShape)& EdgePresentation() const { return myEdgeIdPrs; }
+
+  //! Return estimated memory in bytes for vertex and index buffers of ID presentations.
+  //! Buffers are uploaded to GPU on the first Pick(), but the size is known once presentations are computed.
+  Standard_Size EstimatedDataSize() const;
+
+  //! Return face or edge by ID.
+  const TopoDS_Shape& SubShape (int theId) const
+  {
+    return theId <= myFaces.Extent() ? myFaces.FindKey (theId) : myEdges.FindKey (theId - myFaces.Extent());
+  }
+
+  //! Render IDs around the point and return ID of the nearest picked face or edge.
+  //! @param theView      view defining camera and viewport size
+  //! @param thePnt       point in window coordinates (top-down)
+  //! @param theTolerance pixel tolerance
+  //! @return sub-shape ID or 0 if nothing has been picked
+  int Pick (const Handle(V3d_View)& theView,
+            const Graphic3d_Vec2i&  thePnt,
+            int theTolerance);
+
+private:
+
+  Handle(V3d_Viewer)             myViewer;  //!< picking viewer
+  Handle(V3d_View)               myView;    //!< picking view
+  Handle(AIS_InteractiveContext) myContext; //!< picking context
+  Handle(AIS_ColoredShape)       myIdPrs;     //!< presentation with per-face ID colors
+  Handle(AIS_ColoredShape)       myEdgeIdPrs; //!< presentation with per-edge ID colors
+  TopTools_IndexedMapOfShape     myFaces;     //!< map of pickable faces
+  TopTools_IndexedMapOfShape     myEdges;     //!< map of pickable edges
+  Image_PixMap                   myImage;   //!< ID buffer read back
+
+};
+
+#endif // OcctJni_IdPicker_H
@@ -0,0 +1,481 @@
+// Copyright (c) 2014-2021 OPEN CASCADE SAS
+//
+// This file is part of the examples of the Open CASCADE Technology software library.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
+
+#include "OcctJni_OcclusionCuller.hxx"
+
+#include <BRep_Builder.hxx>
+#include <BRepBuilderAPI_MakeVertex.hxx>
+#include <Graphic3d_ShaderProgram.hxx>
+#include <Message.hxx>
+#include <OpenGl_Element.hxx>
+#include <OpenGl_Group.hxx>
+#include <OpenGl_ShaderManager.hxx>
+#include <OpenGl_View.hxx>
+#include <OpenGl_Workspace.hxx>
+#include <Prs3d_PointAspect.hxx>
+#include <TopoDS_Compound.hxx>
+
+#include <EGL/egl.h>
+
+#include <cstring>
+
+namespace
+{
+  static const GLenum THE_GL_ANY_SAMPLES_PASSED_CONSERVATIVE = 0x8D6A;
+  static const GLenum THE_GL_QUERY_RESULT                    = 0x8866;
+  static const GLenum THE_GL_QUERY_RESULT_AVAILABLE          = 0x8867;
+
+  //! Triangle strip covering all faces of the box; box corners are numbered by bits of X, Y and Z.
+  static const int THE_BOX_STRIP[14] = { 3, 2, 7, 6, 4, 2, 0, 3, 1, 7, 5, 4, 1, 0 };
+
+  //! Number of vertices per box.
+  static const int THE_BOX_NB_VERTS = 14;
+
+  //! Load function from OpenGL ES library.
+  template<typename FuncType_t>
+  static bool findProc (const char* theName, FuncType_t& theFunc)
+  {
+    theFunc = (FuncType_t )eglGetProcAddress (theName);
+    return theFunc != NULL;
+  }
+}
+
+//! OpenGL element issuing occlusion queries at the moment of its rendering.
+class OcctJni_OcclusionQueryElement : public OpenGl_Element
+{
+public:
+
+  //! Main constructor.
+  OcctJni_OcclusionQueryElement (OcctJni_OcclusionCuller* theCuller) : myCuller (theCuller) {}
+
+  //! Issue queries against depth buffer of already rendered layers.
+  virtual void Render (const Handle(OpenGl_Workspace)& theWorkspace) const override
+  {
+    myCuller->IssueQueries (theWorkspace->GetGlContext(), theWorkspace->View()->Camera());
+  }
+
+  //! Release OpenGL resources (nothing to release).
+  virtual void Release (OpenGl_Context* ) override {}
+
+private:
+
+  OcctJni_OcclusionCuller* myCuller; //!< occlusion culler
+
+};
+
+//! Invisible presentation spanning all parts and issuing occlusion queries.
+class OcctJni_OcclusionQueryPrs : public AIS_Shape
+{
+  DEFINE_STANDARD_RTTI_INLINE(OcctJni_OcclusionQueryPrs, AIS_Shape)
+public:
+
+  //! Main constructor.
+  OcctJni_OcclusionQueryPrs (const TopoDS_Shape& theCorners,
+                             OcctJni_OcclusionCuller* theCuller)
+  : AIS_Shape (theCorners), myCuller (theCuller) {}
+
+protected:
+
+  //! Compute presentation of corners followed by query element.
+  virtual void Compute (const Handle(PrsMgr_PresentationManager)& thePrsMgr,
+                        const Handle(Prs3d_Presentation)& thePrs,
+                        const Standard_Integer theMode) override
+  {
+    AIS_Shape::Compute (thePrsMgr, thePrs, theMode);
+    Handle(OpenGl_Group) aGroup = Handle(OpenGl_Group)::DownCast (thePrs->NewGroup());
+    aGroup->AddElement (new OcctJni_OcclusionQueryElement (myCuller));
+  }
+
+private:
+
+  OcctJni_OcclusionCuller* myCuller; //!< occlusion culler
+
+};
+
+// =======================================================================
+// function : OcctJni_OcclusionCuller
+// purpose  :
+// =======================================================================
+OcctJni_OcclusionCuller::OcctJni_OcclusionCuller()
+: myZLayer (Graphic3d_ZLayerId_UNKNOWN),
+  myNbVisible (0),
+  myNbPending (0),
+  myIsSupported (false),
+  myIsGlDirty (true),
+  myToRequery (true)
+{
+  memset (&myFuncs, 0, sizeof(myFuncs));
+}
+
+// =======================================================================
+// function : Init
+// purpose  :
+// =======================================================================
+void OcctJni_OcclusionCuller::Init (const Handle(V3d_Viewer)& theViewer)
+{
+  if (myZLayer != Graphic3d_ZLayerId_UNKNOWN)
+  {
+    return;
+  }
+
+  // immediate layers (view cube, overlays) clear depth buffer, so that queries should be issued before them
+  Graphic3d_ZLayerSettings aSettings;
+  aSettings.SetName ("Occlusion queries");
+  aSettings.SetImmediate (false);
+  aSettings.SetClearDepth (false);
+  aSettings.SetEnableDepthTest (true);
+  aSettings.SetEnableDepthWrite (false);
+  if (!theViewer->InsertLayerAfter (myZLayer, aSettings, Graphic3d_ZLayerId_Default))
+  {
+    Message::SendFail ("Error: occlusion query layer can not be created");
+    myZLayer = Graphic3d_ZLayerId_UNKNOWN;
+  }
+}
+
+// =======================================================================
+// function : Release
+// purpose  :
+// =======================================================================
+void OcctJni_OcclusionCuller::Release()
+{
+  // layer is destroyed together with the viewer
+  myZLayer = Graphic3d_ZLayerId_UNKNOWN;
+  if (myGlCtx.IsNull())
+  {
+    return;
+  }
+
+  for (NCollection_Vector<Part>::Iterator aPartIter (myParts); aPartIter.More(); aPartIter.Next())
+  {
+    Part& aPart = aPartIter.ChangeValue();
+    if (aPart.Query != 0)
+    {
+      myFuncs.glDeleteQueries (1, &aPart.Query);
+      aPart.Query = 0;
+    }
+    aPart.IsPending = false;
+  }
+  myNbPending = 0;
+
+  if (!myBoxesVbo.IsNull())
+  {
+    myBoxesVbo->Release (myGlCtx.get());
+    myBoxesVbo.Nullify();
+  }
+  if (!myProgram.IsNull())
+  {
+    myGlCtx->ShaderManager()->Unregister (myProgramKey, myProgram);
+  }
+  myGlCtx.Nullify();
+  myIsGlDirty = true;
+}
+
+// =======================================================================
+// function : SetParts
+// purpose  :
+// =======================================================================
+void OcctJni_OcclusionCuller::SetParts (const NCollection_Sequence<Handle(AIS_Shape)>& theParts)
+{
+  for (NCollection_Vector<Part>::Iterator aPartIter (myParts); aPartIter.More(); aPartIter.Next())
+  {
+    if (aPartIter.Value().Query != 0)
+    {
+      myFuncs.glDeleteQueries (1, &aPartIter.Value().Query);
+    }
+  }
+  myParts.Clear();
+  myPartPrsList = theParts;
+  myBoundsPrs.Nullify();
+
+  Bnd_Box aBounds;
+  for (NCollection_Sequence<Handle(AIS_Shape)>::Iterator aPrsIter (myPartPrsList); aPrsIter.More(); aPrsIter.Next())
+  {
+    Part& aPart = myParts.Appended();
+    aPart.Box = aPrsIter.Value()->BoundingBox();
+    aBounds.Add (aPart.Box);
+  }
+  myNbVisible = myParts.Size();
+  myNbPending = 0;
+  myIsGlDirty = true;
+  myToRequery = true;
+
+  if (!aBounds.IsVoid())
+  {
+    // pair of vertices drawn by empty markers
+    BRep_Builder    aBuilder;
+    TopoDS_Compound aCorners;
+    aBuilder.MakeCompound (aCorners);
+    aBuilder.Add (aCorners, BRepBuilderAPI_MakeVertex (aBounds.CornerMin()).Vertex());
+    aBuilder.Add (aCorners, BRepBuilderAPI_MakeVertex (aBounds.CornerMax()).Vertex());
+    myBoundsPrs = new OcctJni_OcclusionQueryPrs (aCorners, this);
+    myBoundsPrs->Attributes()->SetPointAspect (new Prs3d_PointAspect (Aspect_TOM_EMPTY, Quantity_NOC_BLACK, 1.0));
+    if (myZLayer != Graphic3d_ZLayerId_UNKNOWN)
+    {
+      myBoundsPrs->SetZLayer (myZLayer);
+    }
+  }
+}
+
+// =======================================================================
+// function : ApplyResults
+// purpose  :
+// =======================================================================
+bool OcctJni_OcclusionCuller::ApplyResults (const Handle(Graphic3d_Camera)& theCamera)
+{
+  if (myGlCtx.IsNull()
+   || !myIsSupported)
+  {
+    return false;
+  }
+
+  const gp_Pnt anEye = theCamera->Eye();
+  bool isChanged = false;
+  for (int aPartIter = 0; aPartIter < myParts.Size(); ++aPartIter)
+  {
+    Part& aPart = myParts.ChangeValue (aPartIter);
+    bool isVisible = aPart.IsVisible;
+    if (aPart.IsPending)
+    {
+      GLuint isAvailable = 0;
+      myFuncs.glGetQueryObjectuiv (aPart.Query, THE_GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+      if (isAvailable != 0)
+      {
+        GLuint aNbSamples = 0;
+        myFuncs.glGetQueryObjectuiv (aPart.Query, THE_GL_QUERY_RESULT, &aNbSamples);
+        aPart.IsPending = false;
+        --myNbPending;
+        isVisible = aNbSamples != 0;
+      }
+    }
+    if (!aPart.Box.IsOut (anEye))
+    {
+      // box faces behind the near plane cannot be tested
+      isVisible = true;
+    }
+    if (isVisible == aPart.IsVisible)
+    {
+      continue;
+    }
+
+    aPart.IsVisible = isVisible;
+    myNbVisible += isVisible ? 1 : -1;
+    const Handle(AIS_Shape)& aPrs = myPartPrsList.Value (aPartIter + 1);
+    for (PrsMgr_Presentations::Iterator aPrsIter (aPrs->Presentations()); aPrsIter.More(); aPrsIter.Next())
+    {
+      aPrsIter.Value()->SetVisible (isVisible);
+    }
+    isChanged = true;
+  }
+  if (isChanged)
+  {
+    // depth buffer has been changed
+    myToRequery = true;
+  }
+  return isChanged;
+}
+
+// =======================================================================
+// function : forgetGlResources
+// purpose  :
+// =======================================================================
+void OcctJni_OcclusionCuller::forgetGlResources()
+{
+  for (NCollection_Vector<Part>::Iterator aPartIter (myParts); aPartIter.More(); aPartIter.Next())
+  {
+    aPartIter.ChangeValue().Query = 0;
+    aPartIter.ChangeValue().IsPending = false;
+  }
+  myNbPending = 0;
+  myBoxesVbo.Nullify();
+  myProgram.Nullify();
+  myProgramKey.Clear();
+  myGlCtx.Nullify();
+}
+
+// =======================================================================
+// function : initGlResources
+// purpose  :
+// =======================================================================
+bool OcctJni_OcclusionCuller::initGlResources (const Handle(OpenGl_Context)& theCtx)
+{
+  if (!myGlCtx.IsNull()
+    && myGlCtx != theCtx)
+  {
+    forgetGlResources();
+  }
+  myGlCtx = theCtx;
+
+  if (myProgram.IsNull())
+  {
+    const bool isCore = theCtx->IsGlGreaterEqual (3, 0);
+    if (!isCore
+     && !theCtx->CheckExtension ("GL_EXT_occlusion_query_boolean"))
+    {
+      Message::SendWarning ("Warning: occlusion queries are not supported");
+      return false;
+    }
+    if (!findProc (isCore ? "glGenQueries"        : "glGenQueriesEXT",        myFuncs.glGenQueries)
+     || !findProc (isCore ? "glDeleteQueries"     : "glDeleteQueriesEXT",     myFuncs.glDeleteQueries)
+     || !findProc (isCore ? "glBeginQuery"        : "glBeginQueryEXT",        myFuncs.glBeginQuery)
+     || !findProc (isCore ? "glEndQuery"          : "glEndQueryEXT",          myFuncs.glEndQuery)
+     || !findProc (isCore ? "glGetQueryObjectuiv" : "glGetQueryObjectuivEXT", myFuncs.glGetQueryObjectuiv))
+    {
+      Message::SendWarning ("Warning: occlusion query functions can not be found");
+      return false;
+    }
+
+    Handle(Graphic3d_ShaderProgram) aProgramSrc = new Graphic3d_ShaderProgram();
+    aProgramSrc->SetNbLightsMax (0);
+    aProgramSrc->SetNbClipPlanesMax (0);
+    aProgramSrc->AttachShader (Graphic3d_ShaderObject::CreateFromSource (Graphic3d_TOS_VERTEX,
+      "uniform mat4 uMvp;\n"
+      "void main() { gl_Position = uMvp * occVertex; }"));
+    aProgramSrc->AttachShader (Graphic3d_ShaderObject::CreateFromSource (Graphic3d_TOS_FRAGMENT,
+      "void main() { occSetFragColor (vec4 (1.0)); }"));
+    if (!theCtx->ShaderManager()->Create (aProgramSrc, myProgramKey, myProgram))
+    {
+      Message::SendFail ("Error: occlusion query program can not be created");
+      return false;
+    }
+  }
+
+  if (myParts.IsEmpty())
+  {
+    return true;
+  }
+
+  NCollection_Array1<OpenGl_Vec3> aVerts (0, myParts.Size() * THE_BOX_NB_VERTS - 1);
+  for (int aPartIter = 0; aPartIter < myParts.Size(); ++aPartIter)
+  {
+    Part& aPart = myParts.ChangeValue (aPartIter);
+    if (aPart.Query == 0)
+    {
+      myFuncs.glGenQueries (1, &aPart.Query);
+    }
+
+    OpenGl_Vec3 aCorners[2];
+    if (!aPart.Box.IsVoid())
+    {
+      const gp_Pnt aMin = aPart.Box.CornerMin();
+      const gp_Pnt aMax = aPart.Box.CornerMax();
+      aCorners[0] = OpenGl_Vec3 ((float )aMin.X(), (float )aMin.Y(), (float )aMin.Z());
+      aCorners[1] = OpenGl_Vec3 ((float )aMax.X(), (float )aMax.Y(), (float )aMax.Z());
+    }
+    for (int aVertIter = 0; aVertIter < THE_BOX_NB_VERTS; ++aVertIter)
+    {
+      const int aCorner = THE_BOX_STRIP[aVertIter];
+      aVerts.ChangeValue (aPartIter * THE_BOX_NB_VERTS + aVertIter) = OpenGl_Vec3 (aCorners[(aCorner     ) & 1].x(),
+                                                                                    aCorners[(aCorner >> 1) & 1].y(),
+                                                                                    aCorners[(aCorner >> 2) & 1].z());
+    }
+  }
+
+  if (myBoxesVbo.IsNull())
+  {
+    myBoxesVbo = new OpenGl_VertexBuffer();
+  }
+  if (!myBoxesVbo->Init (theCtx, 3, aVerts.Length(), aVerts.First().GetData()))
+  {
+    Message::SendFail ("Error: occlusion query boxes can not be uploaded");
+    return false;
+  }
+  return true;
+}
+
+// =======================================================================
+// function : IssueQueries
+// purpose  :
+// =======================================================================
+void OcctJni_OcclusionCuller::IssueQueries (const Handle(OpenGl_Context)&   theCtx,
+                                            const Handle(Graphic3d_Camera)& theCamera)
+{
+  if (myParts.IsEmpty()
+   || theCtx.IsNull())
+  {
+    return;
+  }
+  if (myIsGlDirty
+   || myGlCtx != theCtx)
+  {
+    // resources of another context are forgotten by initGlResources()
+    myIsSupported = initGlResources (theCtx);
+    myIsGlDirty = false;
+  }
+  if (!myIsSupported
+   || (!myToRequery && !myCameraState.IsChanged (theCamera->WorldViewProjState())))
+  {
+    return;
+  }
+  myCameraState = theCamera->WorldViewProjState();
+  myToRequery = false;
+
+  // test boxes against depth buffer without modifying it
+  const bool wasColorMask = theCtx->SetColorMask (false);
+  GLboolean wasDepthMask = GL_TRUE;
+  GLint aDepthFunc = GL_LESS;
+  theCtx->core20fwd->glGetBooleanv (GL_DEPTH_WRITEMASK, &wasDepthMask);
+  theCtx->core20fwd->glGetIntegerv (GL_DEPTH_FUNC, &aDepthFunc);
+  const bool wasDepthTest = theCtx->core20fwd->glIsEnabled (GL_DEPTH_TEST) == GL_TRUE;
+  const bool wasCullFace  = theCtx->core20fwd->glIsEnabled (GL_CULL_FACE)  == GL_TRUE;
+  theCtx->core20fwd->glDepthMask (GL_FALSE);
+  theCtx->core20fwd->glDepthFunc (GL_LEQUAL);
+  theCtx->core20fwd->glEnable (GL_DEPTH_TEST);
+  theCtx->core20fwd->glDisable (GL_CULL_FACE);
+
+  const OpenGl_Mat4 aMvp = theCamera->ProjectionMatrixF() * theCamera->OrientationMatrixF();
+  theCtx->BindProgram (myProgram);
+  myProgram->SetUniform (theCtx, "uMvp", aMvp);
+  myBoxesVbo->BindAttribute (theCtx, Graphic3d_TOA_POS);
+  for (int aPartIter = 0; aPartIter < myParts.Size(); ++aPartIter)
+  {
+    Part& aPart = myParts.ChangeValue (aPartIter);
+    if (aPart.Box.IsVoid())
+    {
+      continue;
+    }
+    else if (aPart.IsPending)
+    {
+      // result of previous query is outdated - repeat query next frame
+      myToRequery = true;
+      continue;
+    }
+
+    myFuncs.glBeginQuery (THE_GL_ANY_SAMPLES_PASSED_CONSERVATIVE, aPart.Query);
+    theCtx->core20fwd->glDrawArrays (GL_TRIANGLE_STRIP, aPartIter * THE_BOX_NB_VERTS, THE_BOX_NB_VERTS);
+    myFuncs.glEndQuery (THE_GL_ANY_SAMPLES_PASSED_CONSERVATIVE);
+    aPart.IsPending = true;
+    ++myNbPending;
+  }
+  myBoxesVbo->UnbindAttribute (theCtx, Graphic3d_TOA_POS);
+  theCtx->BindProgram (Handle(OpenGl_ShaderProgram)());
+
+  theCtx->core20fwd->glDepthMask (wasDepthMask);
+  theCtx->core20fwd->glDepthFunc (aDepthFunc);
+  if (!wasDepthTest)
+  {
+    theCtx->core20fwd->glDisable (GL_DEPTH_TEST);
+  }
+  if (wasCullFace)
+  {
+    theCtx->core20fwd->glEnable (GL_CULL_FACE);
+  }
+  theCtx->SetColorMask (wasColorMask);
+}
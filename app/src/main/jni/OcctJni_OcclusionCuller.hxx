@@ -0,0 +1,146 @@
+// Copyright (c) 2014-2021 OPEN CASCADE SAS
+//
+// This file is part of the examples of the Open CASCADE Technology software library.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
+
+#ifndef OcctJni_OcclusionCuller_H
+#define OcctJni_OcclusionCuller_H
+
+#include <AIS_Shape.hxx>
+#include <Bnd_Box.hxx>
+#include <Graphic3d_WorldViewProjState.hxx>
+#include <NCollection_Sequence.hxx>
+#include <NCollection_Vector.hxx>
+#include <OpenGl_Context.hxx>
+#include <OpenGl_ShaderProgram.hxx>
+#include <OpenGl_VertexBuffer.hxx>
+#include <V3d_Viewer.hxx>
+
+//! Occlusion culling of assembly parts using hardware occlusion queries.
+//! Bounding boxes of parts are tested against depth buffer of the rendered frame
+//! right after the default Z layer (before overlay layers clearing depth buffer),
+//! and query results are applied to the next frame (temporal coherence),
+//! so that queries never stall rendering pipeline.
+//! Parts are culled by hiding their presentations.
+class OcctJni_OcclusionCuller
+{
+public:
+
+  //! Empty constructor.
+  OcctJni_OcclusionCuller();
+
+  //! Create Z layer for issuing queries after the default layer within the viewer.
+  void Init (const Handle(V3d_Viewer)& theViewer);
+
+  //! Release OpenGL resources; should be called while OpenGL context is still alive.
+  void Release();
+
+  //! Set parts to be culled; all parts are initially visible.
+  void SetParts (const NCollection_Sequence<Handle(AIS_Shape)>& theParts);
+
+  //! Return parts.
+  const NCollection_Sequence<Handle(AIS_Shape)>& Parts() const { return myPartPrsList; }
+
+  //! Forget OpenGL resources of the lost context (without releasing them) and re-query parts
+  //! within the new one; should be called when rendering context has been re-created.
+  void ResetContext()
+  {
+    forgetGlResources();
+    myIsGlDirty = true;
+    myToRequery = true;
+  }
+
+  //! Return auxiliary invisible presentation spanning all parts.
+  //! It should be displayed to keep culled parts within automatic Z range of the view,
+  //! otherwise they would never be detected as visible again.
+  //! Rendering of this presentation issues occlusion queries.
+  const Handle(AIS_Shape)& BoundsPresentation() const { return myBoundsPrs; }
+
+  //! Return the number of visible parts.
+  int NbVisible() const { return myNbVisible; }
+
+  //! Return the number of culled parts.
+  int NbCulled() const { return myParts.Size() - myNbVisible; }
+
+  //! Return TRUE if there are queries waiting for result.
+  bool HasPendingQueries() const { return myNbPending > 0; }
+
+  //! Apply available results of previous queries; should be called before frame rendering.
+  //! @param theCamera camera of the next frame; parts around the eye are always visible
+  //! @return TRUE if visibility of some part has been changed
+  bool ApplyResults (const Handle(Graphic3d_Camera)& theCamera);
+
+  //! Issue occlusion queries for parts against depth buffer of the rendered frame;
+  //! called while rendering BoundsPresentation() after the default layer.
+  //! Queries are skipped if neither camera nor visibility has been changed since previous queries.
+  void IssueQueries (const Handle(OpenGl_Context)&   theCtx,
+                     const Handle(Graphic3d_Camera)& theCamera);
+
+private:
+
+  //! Forget OpenGL resources of lost OpenGL context without releasing them.
+  void forgetGlResources();
+
+  //! Initialize OpenGL resources.
+  bool initGlResources (const Handle(OpenGl_Context)& theCtx);
+
+private:
+
+  //! Occlusion query function pointers (GLES 3.0 or GL_EXT_occlusion_query_boolean).
+  struct QueryFunctions
+  {
+    void (GL_APIENTRY *glGenQueries)        (GLsizei theNb, GLuint* theIds);
+    void (GL_APIENTRY *glDeleteQueries)     (GLsizei theNb, const GLuint* theIds);
+    void (GL_APIENTRY *glBeginQuery)        (GLenum theTarget, GLuint theId);
+    void (GL_APIENTRY *glEndQuery)          (GLenum theTarget);
+    void (GL_APIENTRY *glGetQueryObjectuiv) (GLuint theId, GLenum theName, GLuint* theParams);
+  };
+
+  //! Part state.
+  struct Part
+  {
+    Bnd_Box Box;        //!< bounding box
+    GLuint  Query;      //!< query object
+    bool    IsVisible;  //!< visibility state
+    bool    IsPending;  //!< query has been issued and waits for result
+
+    Part() : Query (0), IsVisible (true), IsPending (false) {}
+  };
+
+private:
+
+  NCollection_Sequence<Handle(AIS_Shape)> myPartPrsList;  //!< part presentations
+  NCollection_Vector<Part>                myParts;        //!< part states
+  Handle(AIS_Shape)                       myBoundsPrs;    //!< invisible presentation spanning all parts
+  Handle(OpenGl_Context)                  myGlCtx;        //!< OpenGL context owning resources
+  Handle(OpenGl_ShaderProgram)            myProgram;      //!< program drawing boxes
+  TCollection_AsciiString                 myProgramKey;   //!< program sharing key
+  Handle(OpenGl_VertexBuffer)             myBoxesVbo;     //!< triangle strips of part boxes
+  QueryFunctions                          myFuncs;        //!< query functions
+  Graphic3d_WorldViewProjState            myCameraState;  //!< camera state of previous queries
+  Graphic3d_ZLayerId                      myZLayer;       //!< layer issuing queries after the default one
+  int                                     myNbVisible;    //!< number of visible parts
+  int                                     myNbPending;    //!< number of pending queries
+  bool                                    myIsSupported;  //!< occlusion queries are supported
+  bool                                    myIsGlDirty;    //!< OpenGL resources should be updated
+  bool                                    myToRequery;    //!< visibility has been changed since previous queries
+
+};
+
+#endif // OcctJni_OcclusionCuller_H
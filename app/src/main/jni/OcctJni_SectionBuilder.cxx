@@ -0,0 +1,342 @@
+// Copyright (c) 2014-2021 OPEN CASCADE SAS
+//
+// This file is part of the examples of the Open CASCADE Technology software library.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
+
+#include "OcctJni_SectionBuilder.hxx"
+
+#include <BOPAlgo_Tools.hxx>
+#include <BOPTools_AlgoTools3D.hxx>
+#include <BRep_Builder.hxx>
+#include <BRepAlgoAPI_Section.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepClass3d_SolidClassifier.hxx>
+#include <IntTools_Context.hxx>
+#include <Message.hxx>
+#include <OSD_Timer.hxx>
+#include <Precision.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+
+namespace
+{
+  //! Maximum number of cached sections.
+  static const int THE_CACHE_SIZE_MAX = 16;
+}
+
+// =======================================================================
+// function : OcctJni_SectionBuilder
+// purpose  :
+// =======================================================================
+OcctJni_SectionBuilder::OcctJni_SectionBuilder()
+: myThread (runThread),
+  myElapsedTime (0.0),
+  myKey (-1),
+  myPendingKey (-1),
+  myIsRunning (false),
+  myHasPending (false),
+  myIsFinished (false)
+{
+  //
+}
+
+// =======================================================================
+// function : ~OcctJni_SectionBuilder
+// purpose  :
+// =======================================================================
+OcctJni_SectionBuilder::~OcctJni_SectionBuilder()
+{
+  abortAndWait();
+}
+
+// =======================================================================
+// function : abortAndWait
+// purpose  :
+// =======================================================================
+void OcctJni_SectionBuilder::abortAndWait()
+{
+  myHasPending = false;
+  if (!myIsRunning)
+  {
+    return;
+  }
+
+  myProgress->Abort();
+  myThread.Wait();
+  myIsRunning = false;
+  myResult.Nullify();
+}
+
+// =======================================================================
+// function : SetShape
+// purpose  :
+// =======================================================================
+void OcctJni_SectionBuilder::SetShape (const TopoDS_Shape& theShape)
+{
+  // working thread reads the shape, so that it should be stopped before shape is re-tessellated
+  abortAndWait();
+  if (!theShape.IsNull()
+    && theShape.IsSame (myShape))
+  {
+    return;
+  }
+
+  myCache.Clear();
+  myCacheOrder.Clear();
+  mySolids.Clear();
+  myShape = theShape;
+  for (TopExp_Explorer aSolidIter (myShape, TopAbs_SOLID); aSolidIter.More(); aSolidIter.Next())
+  {
+    Solid& aSolid = mySolids.Appended();
+    aSolid.Shape = aSolidIter.Current();
+    BRepBndLib::Add (aSolid.Shape, aSolid.Box, Standard_False);
+  }
+}
+
+// =======================================================================
+// function : Find
+// purpose  :
+// =======================================================================
+bool OcctJni_SectionBuilder::Find (int theKey,
+                                   TopoDS_Shape& theSection)
+{
+  if (!myCache.Find (theKey, theSection))
+  {
+    return false;
+  }
+
+  myCacheOrder.Remove (theKey);
+  myCacheOrder.Append (theKey);
+  return true;
+}
+
+// =======================================================================
+// function : cacheSection
+// purpose  :
+// =======================================================================
+void OcctJni_SectionBuilder::cacheSection (int theKey,
+                                           const TopoDS_Shape& theSection)
+{
+  if (myCache.IsBound (theKey))
+  {
+    myCacheOrder.Remove (theKey);
+  }
+  myCache.Bind (theKey, theSection);
+  myCacheOrder.Append (theKey);
+  while (myCacheOrder.Extent() > THE_CACHE_SIZE_MAX)
+  {
+    myCache.UnBind (myCacheOrder.First());
+    myCacheOrder.RemoveFirst();
+  }
+}
+
+// =======================================================================
+// function : Request
+// purpose  :
+// =======================================================================
+void OcctJni_SectionBuilder::Request (int theKey,
+                                      const gp_Pln& thePlane)
+{
+  if (myShape.IsNull())
+  {
+    return;
+  }
+
+  myPendingKey   = theKey;
+  myPendingPlane = thePlane;
+  myHasPending   = true;
+  if (!myIsRunning)
+  {
+    startPending();
+  }
+  else if (myKey == theKey
+       && !myProgress->UserBreak())
+  {
+    // running computation is up to date
+    myHasPending = false;
+  }
+  else
+  {
+    // result of running computation is obsolete
+    myProgress->Abort();
+  }
+}
+
+// =======================================================================
+// function : startPending
+// purpose  :
+// =======================================================================
+void OcctJni_SectionBuilder::startPending()
+{
+  myHasPending = false;
+  if (myCache.IsBound (myPendingKey))
+  {
+    return;
+  }
+
+  myKey         = myPendingKey;
+  myPlane       = myPendingPlane;
+  myProgress    = new OcctJni_SectionProgress();
+  myIsFinished  = false;
+  myIsRunning   = true;
+  myThread.Run (this);
+}
+
+// =======================================================================
+// function : Fetch
+// purpose  :
+// =======================================================================
+bool OcctJni_SectionBuilder::Fetch (int& theKey,
+                                    TopoDS_Shape& theSection)
+{
+  if (!myIsRunning
+   || !myIsFinished)
+  {
+    return false;
+  }
+
+  myThread.Wait();
+  myIsRunning = false;
+
+  bool isComputed = false;
+  if (!myProgress->UserBreak())
+  {
+    // messages are reported here, as the printer is bound to JNI environment of rendering thread
+    if (!myResult.IsNull())
+    {
+      Message::SendInfo (TCollection_AsciiString() + "Section computed in " + myElapsedTime + " seconds");
+    }
+    else
+    {
+      Message::SendFail ("Error: section computation has failed");
+    }
+    cacheSection (myKey, myResult);
+    theKey     = myKey;
+    theSection = myResult;
+    isComputed = true;
+  }
+  myResult.Nullify();
+
+  if (myHasPending)
+  {
+    startPending();
+  }
+  return isComputed;
+}
+
+// =======================================================================
+// function : runThread
+// purpose  :
+// =======================================================================
+Standard_Address OcctJni_SectionBuilder::runThread (Standard_Address theBuilder)
+{
+  OcctJni_SectionBuilder* aBuilder = (OcctJni_SectionBuilder* )theBuilder;
+  aBuilder->perform();
+  aBuilder->myIsFinished = true;
+  return NULL;
+}
+
+// =======================================================================
+// function : isInMaterial
+// purpose  :
+// =======================================================================
+bool OcctJni_SectionBuilder::isInMaterial (const gp_Pnt& thePnt) const
+{
+  if (mySolids.IsEmpty())
+  {
+    // there is no material to classify against
+    return true;
+  }
+
+  for (NCollection_Vector<Solid>::Iterator aSolidIter (mySolids); aSolidIter.More(); aSolidIter.Next())
+  {
+    const Solid& aSolid = aSolidIter.Value();
+    if (aSolid.Box.IsOut (thePnt))
+    {
+      continue;
+    }
+
+    BRepClass3d_SolidClassifier aClassifier (aSolid.Shape, thePnt, Precision::Confusion());
+    if (aClassifier.State() == TopAbs_IN
+     || aClassifier.State() == TopAbs_ON)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// =======================================================================
+// function : perform
+// purpose  :
+// =======================================================================
+void OcctJni_SectionBuilder::perform()
+{
+  OSD_Timer aTimer;
+  aTimer.Start();
+  myResult.Nullify();
+  try
+  {
+    BRepAlgoAPI_Section aSectionAlgo (myShape, myPlane, Standard_False);
+    aSectionAlgo.SetRunParallel (Standard_True);
+    aSectionAlgo.SetNonDestructive (Standard_True); // the shape is displayed meanwhile and should not be modified
+    aSectionAlgo.Approximation (Standard_True);
+    aSectionAlgo.Build (myProgress->Start());
+    if (!aSectionAlgo.IsDone()
+      || aSectionAlgo.HasErrors()
+      || myProgress->UserBreak())
+    {
+      return;
+    }
+
+    // build capping faces from closed section contours
+    BRep_Builder    aBuilder;
+    TopoDS_Compound aResult;
+    aBuilder.MakeCompound (aResult);
+    aBuilder.Add (aResult, aSectionAlgo.Shape());
+
+    TopoDS_Shape aWires, aFaces;
+    if (BOPAlgo_Tools::EdgesToWires (aSectionAlgo.Shape(), aWires, Standard_True) == 0
+     && BOPAlgo_Tools::WiresToFaces (aWires, aFaces))
+    {
+      // faces are built for every closed contour including inner ones (bores, hollow tubes),
+      // so that faces outside of material should be dropped
+      Handle(IntTools_Context) aCtx = new IntTools_Context();
+      for (TopExp_Explorer aFaceIter (aFaces, TopAbs_FACE); aFaceIter.More() && !myProgress->UserBreak(); aFaceIter.Next())
+      {
+        const TopoDS_Face& aFace = TopoDS::Face (aFaceIter.Current());
+        gp_Pnt   aPnt;
+        gp_Pnt2d aPnt2d;
+        if (BOPTools_AlgoTools3D::PointInFace (aFace, aPnt, aPnt2d, aCtx) == 0
+         && isInMaterial (aPnt))
+        {
+          aBuilder.Add (aResult, aFace);
+        }
+      }
+    }
+    myResult = aResult;
+  }
+  catch (const Standard_Failure& )
+  {
+    myResult.Nullify();
+  }
+  aTimer.Stop();
+  myElapsedTime = aTimer.ElapsedTime();
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2014-2021 OPEN CASCADE SAS
+//
+// This file is part of the examples of the Open CASCADE Technology software library.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
+
+#ifndef OcctJni_SectionBuilder_H
+#define OcctJni_SectionBuilder_H
+
+#include <Bnd_Box.hxx>
+#include <gp_Pln.hxx>
+#include <Message_ProgressIndicator.hxx>
+#include <NCollection_DataMap.hxx>
+#include <NCollection_List.hxx>
+#include <NCollection_Vector.hxx>
+#include <OSD_Thread.hxx>
+#include <TopoDS_Shape.hxx>
+
+#include <atomic>
+
+//! Progress indicator allowing to abort section computation from another thread.
+class OcctJni_SectionProgress : public Message_ProgressIndicator
+{
+  DEFINE_STANDARD_RTTI_INLINE(OcctJni_SectionProgress, Message_ProgressIndicator)
+public:
+
+  //! Empty constructor.
+  OcctJni_SectionProgress() : myToAbort (false) {}
+
+  //! Request computation to be aborted.
+  void Abort() { myToAbort = true; }
+
+  //! Return TRUE if computation has been aborted.
+  virtual Standard_Boolean UserBreak() override { return myToAbort; }
+
+protected:
+
+  //! Progress is not displayed.
+  virtual void Show (const Message_ProgressScope& ,
+                     const Standard_Boolean ) override {}
+
+private:
+
+  std::atomic<bool> myToAbort;
+
+};
+
+//! Computes exact planar sections of the shape in a background thread.
+//! Only one computation runs at a time - a new request aborts the obsolete one,
+//! and only the latest of requests queued meanwhile is started afterwards.
+//! Results are cached by the key of plane position; only a limited number of recently used sections is kept.
+//! All methods should be called from the same (rendering) thread.
+class OcctJni_SectionBuilder
+{
+public:
+
+  //! Empty constructor.
+  OcctJni_SectionBuilder();
+
+  //! Destructor, aborts the running computation.
+  ~OcctJni_SectionBuilder();
+
+  //! Set shape to be sectioned; aborts the running computation and clears the cache.
+  //! The cache is preserved if the same shape is already set.
+  //! Should be called before computing presentations of the shape, which modify its triangulation.
+  void SetShape (const TopoDS_Shape& theShape);
+
+  //! Return TRUE if computation is running or queued.
+  bool IsBusy() const { return myIsRunning || myHasPending; }
+
+  //! Find the section within the cache and mark it as recently used.
+  bool Find (int theKey,
+             TopoDS_Shape& theSection);
+
+  //! Request section computation for specified plane.
+  void Request (int theKey,
+                const gp_Pln& thePlane);
+
+  //! Check if the running computation has been finished, and start the queued one.
+  //! @param theKey     [out] key of computed section
+  //! @param theSection [out] computed section, also put into the cache
+  //! @return TRUE if new section has been computed
+  bool Fetch (int& theKey,
+              TopoDS_Shape& theSection);
+
+private:
+
+  //! Start computation of queued request.
+  void startPending();
+
+  //! Wait for the running computation to finish.
+  void abortAndWait();
+
+  //! Thread function.
+  static Standard_Address runThread (Standard_Address theBuilder);
+
+  //! Perform section computation within working thread.
+  void perform();
+
+  //! Return TRUE if the point lies within material of the shape (or the shape has no solids).
+  bool isInMaterial (const gp_Pnt& thePnt) const;
+
+  //! Put computed section into the cache, evicting the least recently used one.
+  void cacheSection (int theKey,
+                     const TopoDS_Shape& theSection);
+
+private:
+
+  //! Solid of the shape with its bounding box.
+  struct Solid
+  {
+    TopoDS_Shape Shape;
+    Bnd_Box      Box;
+  };
+
+private:
+
+  NCollection_DataMap<int, TopoDS_Shape> myCache;         //!< computed sections
+  NCollection_List<int>                  myCacheOrder;    //!< cached keys from least to most recently used
+  NCollection_Vector<Solid>              mySolids;        //!< solids of the shape for classification of capping faces
+  TopoDS_Shape                           myShape;         //!< shape to section
+  OSD_Thread                             myThread;        //!< working thread
+  Handle(OcctJni_SectionProgress)        myProgress;      //!< progress of running computation
+  gp_Pln                                 myPlane;         //!< plane of running computation
+  gp_Pln                                 myPendingPlane;  //!< plane of queued request
+  TopoDS_Shape                           myResult;        //!< result of running computation
+  double                                 myElapsedTime;   //!< time spent on running computation
+  int                                    myKey;           //!< key of running computation
+  int                                    myPendingKey;    //!< key of queued request
+  bool                                   myIsRunning;     //!< computation has been started
+  bool                                   myHasPending;    //!< request has been queued
+  std::atomic<bool>                      myIsFinished;    //!< working thread has finished computation
+
+};
+
+#endif // OcctJni_SectionBuilder_H
@@ -26,25 +26,37 @@
 #include <AIS_Shape.hxx>
 #include <Aspect_NeutralWindow.hxx>
 #include <Image_AlienPixMap.hxx>
+#include <BRepBndLib.hxx>
 #include <BRepTools.hxx>
 #include <Message_Messenger.hxx>
 #include <Message_PrinterSystemLog.hxx>
+#include <NCollection_Vector.hxx>
 #include <OpenGl_GraphicDriver.hxx>
+#include <OSD_MemInfo.hxx>
 #include <OSD_Timer.hxx>
 #include <Prs3d_DatumAspect.hxx>
+#include <Standard_ArrayStreamBuffer.hxx>
 #include <Standard_Version.hxx>
+#include <TopoDS_Iterator.hxx>
 
 #include <BRepPrimAPI_MakeBox.hxx>
 
 #include <RWStl.hxx>
+#include <RWStl_Reader.hxx>
+#include <Standard_ReadLineBuffer.hxx>
 #include <IGESControl_Reader.hxx>
 #include <STEPControl_Reader.hxx>
 #include <XSControl_WorkSession.hxx>
 
 #include <EGL/egl.h>
 
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/system_properties.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <jni.h>
 
@@ -53,7 +65,14 @@
 // purpose  :
 // =======================================================================
 OcctJni_Viewer::OcctJni_Viewer (float theDispDensity)
-: myDevicePixelRatio (theDispDensity),
+: mySectionPos (0.5),
+  mySectionAxis (-1),
+  mySectionKey (-1),
+  myIsSectionPending (false),
+  myToPickOnGpu (false),
+  myToCullOccluded (false),
+  myToUseCompactVertices (false),
+  myDevicePixelRatio (theDispDensity),
   myIsJniMoreFrames (false)
 {
   SetTouchToleranceScale (theDispDensity);
@@ -157,6 +176,9 @@ bool OcctJni_Viewer::init()
 
     aWindow->SetSize (aWidth, aHeight);
     myView->SetWindow (aWindow, (Aspect_RenderingContext )anEglContext);
+    myIdPicker.Init (myViewer);
+    // queries of the lost context will never become available
+    myOcclusionCuller.ResetContext();
     dumpGlInfo (true);
     return true;
   }
@@ -200,11 +222,15 @@ bool OcctJni_Viewer::init()
   myView->SetImmediateUpdate (false);
   myView->ChangeRenderingParams().Resolution = (unsigned int )(96.0 * myDevicePixelRatio + 0.5);
   myView->ChangeRenderingParams().ToShowStats = true;
-  myView->ChangeRenderingParams().CollectedStats = (Graphic3d_RenderingParams::PerfCounters ) (Graphic3d_RenderingParams::PerfCounters_FrameRate | Graphic3d_RenderingParams::PerfCounters_Triangles);
+  myView->ChangeRenderingParams().CollectedStats = (Graphic3d_RenderingParams::PerfCounters ) (Graphic3d_RenderingParams::PerfCounters_FrameRate | Graphic3d_RenderingParams::PerfCounters_Triangles
+                                                                                                           | Graphic3d_RenderingParams::PerfCounters_Structures
+                                                                                                           | Graphic3d_RenderingParams::PerfCounters_EstimMem);
   myView->ChangeRenderingParams().StatsTextAspect = myTextStyle->Aspect();
   myView->ChangeRenderingParams().StatsTextHeight = (int )myTextStyle->Height();
 
   myView->SetWindow (aWindow, (Aspect_RenderingContext )anEglContext);
+  myIdPicker.Init (myViewer);
+  myOcclusionCuller.Init (myViewer);
   dumpGlInfo (false);
   //myView->TriedronDisplay (Aspect_TOTP_RIGHT_LOWER, Quantity_NOC_WHITE, 0.08 * myDevicePixelRatio, V3d_ZBUFFER);
 
@@ -218,6 +244,8 @@ bool OcctJni_Viewer::init()
 // =======================================================================
 void OcctJni_Viewer::release()
 {
+  myOcclusionCuller.Release();
+  myIdPicker.Release();
   myContext.Nullify();
   myView.Nullify();
   myViewer.Nullify();
@@ -275,19 +303,21 @@ void OcctJni_Viewer::initContent()
     myViewCube->SetAutoStartAnimation (true);
   }
   myContext->Display (myViewCube, false);
+  if (!myCullingLabel.IsNull())
+  {
+    myContext->Display (myCullingLabel, 0, -1, Standard_False);
+  }
 
   OSD_Timer aTimer;
   aTimer.Start();
   if (!myShape.IsNull())
   {
-    Handle(AIS_Shape) aShapePrs = new AIS_Shape (myShape);
-    myContext->Display (aShapePrs, Standard_False);
+    displayShape (myShape);
   }
   else
   {
     BRepPrimAPI_MakeBox aBuilder (1.0, 2.0, 3.0);
-    Handle(AIS_Shape) aShapePrs = new AIS_Shape (aBuilder.Shape());
-    myContext->Display (aShapePrs, Standard_False);
+    displayShape (aBuilder.Shape());
   }
   myView->FitAll();
 
@@ -295,12 +325,190 @@ void OcctJni_Viewer::initContent()
   Message::SendInfo (TCollection_AsciiString() + "Presentation computed in " + aTimer.ElapsedTime() + " seconds");
 }
 
+// =======================================================================
+// function : eraseShape
+// purpose  :
+// =======================================================================
+void OcctJni_Viewer::eraseShape()
+{
+  for (NCollection_Sequence<Handle(AIS_Shape)>::Iterator aPartIter (myOcclusionCuller.Parts()); aPartIter.More(); aPartIter.Next())
+  {
+    myContext->Remove (aPartIter.Value(), Standard_False);
+  }
+  if (!myOcclusionCuller.BoundsPresentation().IsNull())
+  {
+    myContext->Remove (myOcclusionCuller.BoundsPresentation(), Standard_False);
+  }
+  myOcclusionCuller.SetParts (NCollection_Sequence<Handle(AIS_Shape)>());
+
+  Handle(AIS_Shape) aPrsList[3] = { myShapePrs, mySectionPrs, myPickedPrs };
+  for (int aPrsIter = 0; aPrsIter < 3; ++aPrsIter)
+  {
+    if (!aPrsList[aPrsIter].IsNull())
+    {
+      myContext->Remove (aPrsList[aPrsIter], Standard_False);
+    }
+  }
+  mySectionPrs.Nullify();
+  myPickedPrs.Nullify();
+}
+
+// =======================================================================
+// function : setShapeClipPlane
+// purpose  :
+// =======================================================================
+void OcctJni_Viewer::setShapeClipPlane (bool theToAdd)
+{
+  NCollection_Sequence<Handle(PrsMgr_PresentableObject)> aPrsList;
+  aPrsList.Append (myShapePrs);
+  aPrsList.Append (myIdPicker.Presentation());
+  aPrsList.Append (myIdPicker.EdgePresentation());
+  for (NCollection_Sequence<Handle(AIS_Shape)>::Iterator aPartIter (myOcclusionCuller.Parts()); aPartIter.More(); aPartIter.Next())
+  {
+    aPrsList.Append (aPartIter.Value());
+  }
+
+  for (NCollection_Sequence<Handle(PrsMgr_PresentableObject)>::Iterator aPrsIter (aPrsList); aPrsIter.More(); aPrsIter.Next())
+  {
+    const Handle(PrsMgr_PresentableObject)& aPrs = aPrsIter.Value();
+    if (aPrs.IsNull())
+    {
+      continue;
+    }
+    else if (theToAdd)
+    {
+      aPrs->AddClipPlane (myClipPlane);
+    }
+    else
+    {
+      aPrs->RemoveClipPlane (myClipPlane);
+    }
+  }
+}
+
+//! Create shape presentation.
+static Handle(AIS_Shape) createShapePrs (const TopoDS_Shape& theShape,
+                                         bool theToUseCompactVertices)
+{
+  if (theToUseCompactVertices)
+  {
+    return new OcctJni_CompactShape (theShape);
+  }
+  return new AIS_Shape (theShape);
+}
+
+//! Collect parts of the assembly.
+static void explodeParts (const TopoDS_Shape& theShape,
+                          bool theToUseCompactVertices,
+                          NCollection_Sequence<Handle(AIS_Shape)>& theParts)
+{
+  if (theShape.ShapeType() != TopAbs_COMPOUND)
+  {
+    theParts.Append (createShapePrs (theShape, theToUseCompactVertices));
+    return;
+  }
+
+  for (TopoDS_Iterator aSubIter (theShape); aSubIter.More(); aSubIter.Next())
+  {
+    explodeParts (aSubIter.Value(), theToUseCompactVertices, theParts);
+  }
+}
+
+// =======================================================================
+// function : displayShape
+// purpose  :
+// =======================================================================
+void OcctJni_Viewer::displayShape (const TopoDS_Shape& theShape)
+{
+  // stop section computation before tessellation shared with the working thread is modified
+  mySectionBuilder.SetShape (theShape);
+  myShapePrs = createShapePrs (theShape, myToUseCompactVertices);
+  myPickedPrs.Nullify();
+
+  // selection structures are not needed for GPU picking
+  const int aSelMode = myToPickOnGpu ? -1 : 0;
+  if (myToCullOccluded)
+  {
+    NCollection_Sequence<Handle(AIS_Shape)> aParts;
+    explodeParts (theShape, myToUseCompactVertices, aParts);
+    for (NCollection_Sequence<Handle(AIS_Shape)>::Iterator aPartIter (aParts); aPartIter.More(); aPartIter.Next())
+    {
+      myContext->Display (aPartIter.Value(), AIS_Shaded, aSelMode, Standard_False);
+    }
+    myOcclusionCuller.SetParts (aParts);
+    if (!myOcclusionCuller.BoundsPresentation().IsNull())
+    {
+      myContext->Display (myOcclusionCuller.BoundsPresentation(), AIS_WireFrame, -1, Standard_False);
+    }
+    updateCullingLabel();
+  }
+  else
+  {
+    myContext->Display (myShapePrs, AIS_Shaded, aSelMode, Standard_False);
+  }
+  myIdPicker.SetShape (myToPickOnGpu ? theShape : TopoDS_Shape());
+  if (myToUseCompactVertices)
+  {
+    reportVertexData();
+  }
+
+  myShapeBox.SetVoid();
+  BRepBndLib::Add (theShape, myShapeBox);
+  mySectionPrs.Nullify();
+  mySectionKey = -1;
+  updateSectionPlane();
+}
+
+//! Reset peak resident set size of the process (VmHWM), so that it is measured per file.
+//! Returns FALSE if reset is not permitted (peak then covers the whole process lifetime).
+static bool resetPeakMemory()
+{
+  const int aFile = ::open ("/proc/self/clear_refs", O_WRONLY);
+  if (aFile == -1)
+  {
+    return false;
+  }
+
+  const bool isReset = ::write (aFile, "5", 1) == 1;
+  ::close (aFile);
+  return isReset;
+}
+
+//! Return memory freed after translation back to the system.
+//! M_PURGE is supported by bionic since Android 9 (API level 28), while the application targets older API levels,
+//! so that device API level is checked and mallopt() is looked up at runtime.
+static void releaseFreeMemory()
+{
+  static const int THE_M_PURGE = -101; // M_PURGE value from bionic <malloc.h>
+  typedef int (*MalloptFunc_t)(int theParam, int theValue);
+
+  char anApiLevelStr[PROP_VALUE_MAX] = {};
+  if (__system_property_get ("ro.build.version.sdk", anApiLevelStr) <= 0
+   || atoi (anApiLevelStr) < 28)
+  {
+    return;
+  }
+
+  static const MalloptFunc_t aMallopt = (MalloptFunc_t )dlsym (RTLD_DEFAULT, "mallopt");
+  if (aMallopt != NULL)
+  {
+    aMallopt (THE_M_PURGE, 0);
+  }
+}
+
 //! Load shape from IGES file
-static TopoDS_Shape loadIGES (const TCollection_AsciiString& thePath)
+static TopoDS_Shape loadIGES (const TCollection_AsciiString& thePath,
+                              std::istream* theStream)
 {
   TopoDS_Shape          aShape;
   IGESControl_Reader    aReader;
   IFSelect_ReturnStatus aReadStatus = IFSelect_RetFail;
+  if (theStream != NULL)
+  {
+    Message::SendFail ("Error: IGES reader does not support reading from memory");
+    return aShape;
+  }
+
   try
   {
     aReadStatus = aReader.ReadFile (thePath.ToCString());
@@ -336,13 +544,26 @@ static TopoDS_Shape loadIGES (const TCollection_AsciiString& thePath)
 }
 
 //! Load shape from STEP file
-static TopoDS_Shape loadSTEP (const TCollection_AsciiString& thePath)
+static TopoDS_Shape loadSTEP (const TCollection_AsciiString& thePath,
+                              std::istream* theStream)
 {
   STEPControl_Reader    aReader;
   IFSelect_ReturnStatus aReadStatus = IFSelect_RetFail;
   try
   {
-    aReadStatus = aReader.ReadFile (thePath.ToCString());
+    if (theStream != NULL)
+    {
+    #if OCC_VERSION_HEX >= 0x070600
+      aReadStatus = aReader.ReadStream (thePath.ToCString(), *theStream);
+    #else
+      Message::SendFail ("Error: STEP reader does not support reading from memory");
+      return TopoDS_Shape();
+    #endif
+    }
+    else
+    {
+      aReadStatus = aReader.ReadFile (thePath.ToCString());
+    }
   }
   catch (Standard_Failure)
   {
@@ -366,22 +587,190 @@ static TopoDS_Shape loadSTEP (const TCollection_AsciiString& thePath)
   return aReader.OneShape();
 }
 
+//! STL reader filling triangulation from stream.
+//! RWStl::ReadFile() provides only file path interface.
+class OcctJni_StlStreamReader : public RWStl_Reader
+{
+public:
+
+  //! Read the stream and return triangulation or NULL on failure.
+  Handle(Poly_Triangulation) ReadStream (std::istream& theStream)
+  {
+    // stream is expected to support seeking, as Standard_ArrayStreamBuffer does
+    theStream.seekg (0, std::ios::end);
+    const std::streampos anEndPos = theStream.tellg();
+    theStream.seekg (0, std::ios::beg);
+
+    const bool isAscii = IsAscii (theStream, true);
+    Standard_ReadLineBuffer aBuffer (THE_BUFFER_SIZE);
+    bool isDone = false;
+    while (theStream.good())
+    {
+      isDone = isAscii
+             ? ReadAscii (theStream, aBuffer, anEndPos)
+             : ReadBinary (theStream);
+      if (!isDone)
+      {
+        break;
+      }
+      theStream >> std::ws; // skip white spaces between solids
+    }
+    if (!isDone
+     || myTriangles.IsEmpty())
+    {
+      return Handle(Poly_Triangulation)();
+    }
+
+    Handle(Poly_Triangulation) aTri = new Poly_Triangulation (myNodes.Length(), myTriangles.Length(), Standard_False);
+    for (int aNodeIter = 0; aNodeIter < myNodes.Length(); ++aNodeIter)
+    {
+      aTri->SetNode (aNodeIter + 1, myNodes.Value (aNodeIter));
+    }
+    for (int aTriIter = 0; aTriIter < myTriangles.Length(); ++aTriIter)
+    {
+      aTri->SetTriangle (aTriIter + 1, myTriangles.Value (aTriIter));
+    }
+    return aTri;
+  }
+
+protected:
+
+  //! Add new node and return its 1-based index.
+  virtual Standard_Integer AddNode (const gp_XYZ& thePnt) override
+  {
+    myNodes.Append (gp_Pnt (thePnt));
+    return myNodes.Length();
+  }
+
+  //! Add new triangle.
+  virtual void AddTriangle (Standard_Integer theNode1,
+                            Standard_Integer theNode2,
+                            Standard_Integer theNode3) override
+  {
+    myTriangles.Append (Poly_Triangle (theNode1, theNode2, theNode3));
+  }
+
+private:
+
+  static const int THE_BUFFER_SIZE = 1024;
+
+  NCollection_Vector<gp_Pnt>        myNodes;
+  NCollection_Vector<Poly_Triangle> myTriangles;
+
+};
+
 //! Load shape from STL file
-static TopoDS_Shape loadSTL (const TCollection_AsciiString& thePath)
+static TopoDS_Shape loadSTL (const TCollection_AsciiString& thePath,
+                             std::istream* theStream)
 {
-  Handle(Poly_Triangulation) aTri = RWStl::ReadFile (thePath.ToCString());
+  Handle(Poly_Triangulation) aTri;
+  try
+  {
+    if (theStream != NULL)
+    {
+      OcctJni_StlStreamReader aReader;
+      aTri = aReader.ReadStream (*theStream);
+    }
+    else
+    {
+      aTri = RWStl::ReadFile (thePath.ToCString());
+    }
+  }
+  catch (Standard_Failure)
+  {
+    aTri.Nullify();
+  }
+  if (aTri.IsNull())
+  {
+    Message::SendFail ("Error: STL reader, bad file format");
+    return TopoDS_Shape();
+  }
   TopoDS_Face aFace;
   BRep_Builder().MakeFace (aFace, aTri);
   return aFace;
 }
 
+//! Load shape from BRep file
+static TopoDS_Shape loadBRep (const TCollection_AsciiString& theName,
+                              const TCollection_AsciiString& thePath,
+                              std::istream* theStream)
+{
+  TopoDS_Shape aShape;
+  BRep_Builder aBuilder;
+  try
+  {
+    if (theStream != NULL)
+    {
+      BRepTools::Read (aShape, *theStream, aBuilder);
+    }
+    else
+    {
+      BRepTools::Read (aShape, thePath.ToCString(), aBuilder);
+    }
+  }
+  catch (Standard_Failure)
+  {
+    aShape.Nullify();
+  }
+
+  if (aShape.IsNull())
+  {
+    Message::SendInfo (TCollection_AsciiString() + "Error: file '" + theName + "' can not be opened");
+  }
+  return aShape;
+}
+
 // =======================================================================
 // function : open
 // purpose  :
 // =======================================================================
 bool OcctJni_Viewer::open (const TCollection_AsciiString& thePath)
+{
+  return openShape (thePath, thePath, NULL);
+}
+
+// =======================================================================
+// function : openFd
+// purpose  :
+// =======================================================================
+bool OcctJni_Viewer::openFd (int theFd,
+                             const TCollection_AsciiString& theName)
+{
+  // re-open descriptor through procfs for readers expecting file path
+  const TCollection_AsciiString aPath = TCollection_AsciiString ("/proc/self/fd/") + theFd;
+  const bool isOpened = openShape (theName, aPath, NULL);
+  ::close (theFd);
+  return isOpened;
+}
+
+// =======================================================================
+// function : openBuffer
+// purpose  :
+// =======================================================================
+bool OcctJni_Viewer::openBuffer (const char* theData,
+                                 size_t      theSize,
+                                 const TCollection_AsciiString& theName)
+{
+  Standard_ArrayStreamBuffer aStreamBuffer (theData, theSize);
+  std::istream aStream (&aStreamBuffer);
+  return openShape (theName, theName, &aStream);
+}
+
+// =======================================================================
+// function : openShape
+// purpose  :
+// =======================================================================
+bool OcctJni_Viewer::openShape (const TCollection_AsciiString& theName,
+                                const TCollection_AsciiString& thePath,
+                                std::istream* theStream)
 {
   myShape.Nullify();
+  myShapePrs.Nullify();
+  mySectionPrs.Nullify();
+  myPickedPrs.Nullify();
+  mySectionBuilder.SetShape (TopoDS_Shape());
+  myIdPicker.SetShape (TopoDS_Shape());
+  myOcclusionCuller.SetParts (NCollection_Sequence<Handle(AIS_Shape)>());
   if (!myContext.IsNull())
   {
     myContext->RemoveAll (Standard_False);
@@ -389,50 +778,64 @@ bool OcctJni_Viewer::open (const TCollection_AsciiString& thePath)
     {
       myContext->Display (myViewCube, false);
     }
+    if (!myCullingLabel.IsNull())
+    {
+      myContext->Display (myCullingLabel, 0, -1, Standard_False);
+    }
+    updateCullingLabel();
   }
-  if (thePath.IsEmpty())
+  if (theName.IsEmpty()
+   || (thePath.IsEmpty() && theStream == NULL))
   {
     return false;
   }
 
+  releaseFreeMemory();
+  const bool isPeakReset = resetPeakMemory();
+  const Standard_Real aMemBefore = OSD_MemInfo().ValuePreciseMiB (OSD_MemInfo::MemWorkingSet);
+
   OSD_Timer aTimer;
   aTimer.Start();
   TCollection_AsciiString aFileName, aFormatStr;
-  OSD_Path::FileNameAndExtension (thePath, aFileName, aFormatStr);
+  OSD_Path::FileNameAndExtension (theName, aFileName, aFormatStr);
     aFormatStr.LowerCase();
 
   TopoDS_Shape aShape;
   if (aFormatStr == "stp"
    || aFormatStr == "step")
   {
-    aShape = loadSTEP (thePath);
+    aShape = loadSTEP (thePath, theStream);
   }
   else if (aFormatStr == "igs"
         || aFormatStr == "iges")
   {
-    aShape = loadIGES (thePath);
+    aShape = loadIGES (thePath, theStream);
   }
   else if (aFormatStr == "stl")
   {
-      aShape = loadSTL (thePath);
+      aShape = loadSTL (thePath, theStream);
   }
   else
       // if (aFormatStr == "brep"
       //  || aFormatStr == "rle")
   {
-    BRep_Builder aBuilder;
-    if (!BRepTools::Read (aShape, thePath.ToCString(), aBuilder))
-    {
-      Message::SendInfo (TCollection_AsciiString() + "Error: file '" + thePath + "' can not be opened");
-      return false;
-    }
+    aShape = loadBRep (theName, thePath, theStream);
   }
+
+  // translation data has been already destroyed together with the reader
+  const Standard_Real aMemBeforePurge = OSD_MemInfo().ValuePreciseMiB (OSD_MemInfo::MemWorkingSet);
+  releaseFreeMemory();
   if (aShape.IsNull())
   {
     return false;
   }
   aTimer.Stop();
-  Message::SendInfo (TCollection_AsciiString() + "File '" + thePath + "' loaded in " + aTimer.ElapsedTime() + " seconds");
+  const OSD_MemInfo aMemInfo;
+  Message::SendInfo (TCollection_AsciiString() + "File '" + theName + "' loaded in " + aTimer.ElapsedTime() + " seconds"
+                   + "\nRSS: " + (int )aMemBefore + " MiB before, "
+                   + (int )aMemInfo.ValuePreciseMiB (OSD_MemInfo::MemWorkingSetPeak) + (isPeakReset ? " MiB peak, " : " MiB process-lifetime peak, ")
+                   + (int )aMemBeforePurge + " MiB after load, "
+                   + (int )aMemInfo.ValuePreciseMiB (OSD_MemInfo::MemWorkingSet) + " MiB after purge");
 
   myShape = aShape;
   if (myContext.IsNull())
@@ -443,8 +846,7 @@ bool OcctJni_Viewer::open (const TCollection_AsciiString& thePath)
   aTimer.Reset();
   aTimer.Start();
 
-  Handle(AIS_Shape) aShapePrs = new AIS_Shape (aShape);
-  myContext->Display (aShapePrs, Standard_False);
+  displayShape (aShape);
   myView->FitAll();
 
   aTimer.Stop();
@@ -506,8 +908,17 @@ bool OcctJni_Viewer::saveSnapshot (const TCollection_AsciiString& thePath,
 void OcctJni_Viewer::handleViewRedraw (const Handle(AIS_InteractiveContext)& theCtx,
                                        const Handle(V3d_View)& theView)
 {
+  if (myOcclusionCuller.ApplyResults (theView->Camera()))
+  {
+    updateCullingLabel();
+    theView->Invalidate();
+  }
+
+  // queries are issued while rendering the frame right after the default layer,
+  // and their results are applied to the next frame
   AIS_ViewController::handleViewRedraw (theCtx, theView);
-  myIsJniMoreFrames = myToAskNextFrame;
+  myIsJniMoreFrames = myToAskNextFrame
+                   || (myToCullOccluded && myOcclusionCuller.HasPendingQueries());
 }
 
 // =======================================================================
@@ -523,6 +934,7 @@ bool OcctJni_Viewer::redraw()
 
   // handle user input
   myIsJniMoreFrames = false;
+  updateSection();
   myView->InvalidateImmediate();
   FlushViewEvents (myContext, myView, true);
   return myIsJniMoreFrames;
@@ -543,6 +955,368 @@ void OcctJni_Viewer::fitAll()
   myView->Invalidate();
 }
 
+// =======================================================================
+// function : setSectionPlane
+// purpose  :
+// =======================================================================
+void OcctJni_Viewer::setSectionPlane (int    theAxis,
+                                      double thePosition)
+{
+  mySectionAxis = theAxis >= 0 && theAxis <= 2 ? theAxis : -1;
+  mySectionPos  = Max (0.0, Min (thePosition, 1.0));
+  updateSectionPlane();
+}
+
+// =======================================================================
+// function : updateSectionPlane
+// purpose  :
+// =======================================================================
+void OcctJni_Viewer::updateSectionPlane()
+{
+  if (myContext.IsNull())
+  {
+    return;
+  }
+
+  if (myClipPlane.IsNull())
+  {
+    myClipPlane = new Graphic3d_ClipPlane();
+    myClipPlane->SetCappingColor (Quantity_NOC_GRAY50);
+  }
+
+  if (mySectionAxis < 0
+   || myShapePrs.IsNull()
+   || myShapeBox.IsVoid())
+  {
+    setShapeClipPlane (false);
+    if (!mySectionPrs.IsNull())
+    {
+      myContext->Remove (mySectionPrs, Standard_False);
+      mySectionPrs.Nullify();
+    }
+    mySectionKey = -1;
+    myIsSectionPending = false;
+    myView->Invalidate();
+    return;
+  }
+
+  // quantize plane position to share cached sections between close positions
+  static const int THE_NB_SECTION_STEPS = 1000;
+  const int aStep = int(mySectionPos * THE_NB_SECTION_STEPS + 0.5);
+  const int aKey  = mySectionAxis * (THE_NB_SECTION_STEPS + 1) + aStep;
+  if (aKey == mySectionKey)
+  {
+    return;
+  }
+
+  // keep the part of the shape below the plane
+  const gp_Pnt aMin = myShapeBox.CornerMin();
+  const gp_Pnt aMax = myShapeBox.CornerMax();
+  const int aCoordIndex = mySectionAxis + 1;
+  gp_XYZ aPnt = (aMin.XYZ() + aMax.XYZ()) * 0.5;
+  aPnt.SetCoord (aCoordIndex, aMin.Coord (aCoordIndex) + (aMax.Coord (aCoordIndex) - aMin.Coord (aCoordIndex)) * aStep / THE_NB_SECTION_STEPS);
+  gp_XYZ aDir (0.0, 0.0, 0.0);
+  aDir.SetCoord (aCoordIndex, -1.0);
+  myClipPlane->SetEquation (gp_Pln (gp_Pnt (aPnt), gp_Dir (aDir)));
+  myClipPlane->SetCapping (true);
+  setShapeClipPlane (true);
+
+  // exact section of previous position is obsolete
+  if (!mySectionPrs.IsNull())
+  {
+    myContext->Remove (mySectionPrs, Standard_False);
+    mySectionPrs.Nullify();
+  }
+
+  mySectionKey = aKey;
+  myIsSectionPending = true;
+  mySectionTimer.Reset();
+  mySectionTimer.Start();
+  myView->Invalidate();
+}
+
+// =======================================================================
+// function : updateSection
+// purpose  :
+// =======================================================================
+void OcctJni_Viewer::updateSection()
+{
+  // delay before requesting exact section to skip intermediate positions while dragging
+  static const double THE_SECTION_DELAY = 0.25;
+
+  int aKey = -1;
+  TopoDS_Shape aSection;
+  if (!mySectionBuilder.Fetch (aKey, aSection)
+    || aKey != mySectionKey)
+  {
+    aKey = -1;
+  }
+
+  if (myIsSectionPending
+   && mySectionTimer.ElapsedTime() >= THE_SECTION_DELAY)
+  {
+    myIsSectionPending = false;
+    if (mySectionBuilder.Find (mySectionKey, aSection))
+    {
+      aKey = mySectionKey;
+    }
+    else
+    {
+      mySectionBuilder.Request (mySectionKey, myClipPlane->ToPlane());
+    }
+  }
+
+  if (aKey >= 0
+  && !aSection.IsNull()
+  && !myContext.IsNull())
+  {
+    // exact capping faces replace capping by clipping plane
+    mySectionPrs = new AIS_Shape (aSection);
+    mySectionPrs->SetColor (Quantity_NOC_RED);
+    myContext->Display (mySectionPrs, AIS_Shaded, -1, Standard_False);
+    myClipPlane->SetCapping (false);
+    myView->Invalidate();
+  }
+}
+
+// =======================================================================
+// function : setGpuPicking
+// purpose  :
+// =======================================================================
+void OcctJni_Viewer::setGpuPicking (bool theToUseGpu)
+{
+  if (myToPickOnGpu == theToUseGpu)
+  {
+    return;
+  }
+
+  myToPickOnGpu = theToUseGpu;
+  if (myContext.IsNull()
+   || myShapePrs.IsNull())
+  {
+    return;
+  }
+
+  myContext->ClearSelected (Standard_False);
+
+  OSD_Timer aTimer;
+  aTimer.Start();
+  const Standard_Size aHeapBefore = OSD_MemInfo().Value (OSD_MemInfo::MemHeapUsage);
+
+  // redisplay the shape to release or restore selection structures
+  const TopoDS_Shape aShape = myShapePrs->Shape();
+  eraseShape();
+  displayShape (aShape);
+  myView->Invalidate();
+
+  aTimer.Stop();
+  const Standard_Size aHeapAfter = OSD_MemInfo().Value (OSD_MemInfo::MemHeapUsage);
+  // selection structures occupy CPU heap, while ID presentations occupy mostly GPU memory
+  const Standard_Size aGpuIdBytes = myIdPicker.EstimatedDataSize();
+  Message::SendInfo (TCollection_AsciiString() + (myToPickOnGpu ? "GPU" : "CPU") + " picking set up in " + aTimer.ElapsedTime() + " seconds"
+                   + " (heap " + (aHeapAfter >= aHeapBefore ? "+" : "-")
+                   + (Standard_Integer )((aHeapAfter >= aHeapBefore ? aHeapAfter - aHeapBefore : aHeapBefore - aHeapAfter) / 1024) + " KiB"
+                   + ", ID buffers " + (Standard_Integer )(aGpuIdBytes / 1024) + " KiB)");
+}
+
+// =======================================================================
+// function : setOcclusionCulling
+// purpose  :
+// =======================================================================
+void OcctJni_Viewer::setOcclusionCulling (bool theToCull)
+{
+  if (myToCullOccluded == theToCull)
+  {
+    return;
+  }
+
+  myToCullOccluded = theToCull;
+  if (!myCullingLabel.IsNull()
+   && !myContext.IsNull())
+  {
+    myContext->Remove (myCullingLabel, Standard_False);
+  }
+  myCullingLabel.Nullify();
+  if (myToCullOccluded
+  && !myTextStyle.IsNull())
+  {
+    // put statistics below frame statistics
+    const int anOffsetY = 20 + int(11.0 * myTextStyle->Height() * myDevicePixelRatio);
+    myCullingLabel = new AIS_TextLabel();
+    myCullingLabel->Attributes()->SetTextAspect (myTextStyle);
+    myCullingLabel->SetPosition (gp_Pnt (0.0, 0.0, 0.0));
+    myCullingLabel->SetZLayer (Graphic3d_ZLayerId_TopOSD);
+    myCullingLabel->SetTransformPersistence (new Graphic3d_TransformPers (Graphic3d_TMF_2d, Aspect_TOTP_LEFT_UPPER, Graphic3d_Vec2i (20, anOffsetY)));
+  }
+  if (myContext.IsNull())
+  {
+    return;
+  }
+
+  if (!myCullingLabel.IsNull())
+  {
+    myContext->Display (myCullingLabel, 0, -1, Standard_False);
+  }
+  if (!myShapePrs.IsNull())
+  {
+    const TopoDS_Shape aShape = myShapePrs->Shape();
+    eraseShape();
+    displayShape (aShape);
+  }
+  updateCullingLabel();
+  myView->Invalidate();
+}
+
+// =======================================================================
+// function : setCompactVertices
+// purpose  :
+// =======================================================================
+void OcctJni_Viewer::setCompactVertices (bool theToUseCompact)
+{
+  if (myToUseCompactVertices == theToUseCompact)
+  {
+    return;
+  }
+
+  myToUseCompactVertices = theToUseCompact;
+  if (myContext.IsNull()
+   || myShapePrs.IsNull())
+  {
+    return;
+  }
+
+  OSD_Timer aTimer;
+  aTimer.Start();
+  const TopoDS_Shape aShape = myShapePrs->Shape();
+  eraseShape();
+  displayShape (aShape);
+  myView->Invalidate();
+  Message::SendInfo (TCollection_AsciiString() + (myToUseCompactVertices ? "Compact" : "Float") + " vertex presentation computed in "
+                   + aTimer.ElapsedTime() + " seconds");
+}
+
+// =======================================================================
+// function : reportVertexData
+// purpose  :
+// =======================================================================
+void OcctJni_Viewer::reportVertexData()
+{
+  NCollection_Sequence<Handle(AIS_Shape)> aPrsList (myOcclusionCuller.Parts());
+  if (aPrsList.IsEmpty())
+  {
+    aPrsList.Append (myShapePrs);
+  }
+
+  Standard_Size aCompactSize = 0, aFloatSize = 0;
+  for (NCollection_Sequence<Handle(AIS_Shape)>::Iterator aPrsIter (aPrsList); aPrsIter.More(); aPrsIter.Next())
+  {
+    if (Handle(OcctJni_CompactShape) aCompactPrs = Handle(OcctJni_CompactShape)::DownCast (aPrsIter.Value()))
+    {
+      aCompactSize += aCompactPrs->CompactDataSize();
+      aFloatSize   += aCompactPrs->FloatDataSize();
+    }
+  }
+  if (aFloatSize == 0)
+  {
+    return;
+  }
+
+  // the same amount of vertex data is fetched by GPU per frame when the whole model is drawn
+  Message::SendInfo (TCollection_AsciiString() + "Vertex data: " + double(aCompactSize) / 1048576.0 + " MiB compact vs "
+                   + double(aFloatSize) / 1048576.0 + " MiB float (" + int(100.0 * double(aCompactSize) / double(aFloatSize)) + "%)"
+                   + "\nNote: compact presentation uses simplified headlight shading instead of OCCT materials and lights,"
+                   + " so that frame rate is not directly comparable");
+}
+
+// =======================================================================
+// function : updateCullingLabel
+// purpose  :
+// =======================================================================
+void OcctJni_Viewer::updateCullingLabel()
+{
+  if (myCullingLabel.IsNull())
+  {
+    return;
+  }
+
+  myCullingLabel->SetText (TCollection_AsciiString() + "Occlusion culling: " + myOcclusionCuller.NbVisible() + " visible, "
+                         + myOcclusionCuller.NbCulled() + " culled parts");
+  myContext->Redisplay (myCullingLabel, Standard_False);
+}
+
+// =======================================================================
+// function : selectInViewer
+// purpose  :
+// =======================================================================
+void OcctJni_Viewer::selectInViewer (const Graphic3d_Vec2i& thePnt)
+{
+  if (!myToPickOnGpu)
+  {
+    SelectInViewer (thePnt);
+    return;
+  }
+  if (myContext.IsNull())
+  {
+    return;
+  }
+
+  // other interactive objects (like view cube) keep selection structures and are handled by CPU selection;
+  // the model itself has no active selection modes, so that it is never detected here
+  myContext->MoveTo (thePnt.x(), thePnt.y(), myView, Standard_False);
+  if (myContext->HasDetected())
+  {
+    SelectInViewer (thePnt);
+    return;
+  }
+
+  OSD_Timer aTimer;
+  aTimer.Start();
+  const int aSubShapeId = myIdPicker.Pick (myView, thePnt, myContext->PixelTolerance());
+  aTimer.Stop();
+
+  if (!myPickedPrs.IsNull())
+  {
+    myContext->Remove (myPickedPrs, Standard_False);
+    myPickedPrs.Nullify();
+  }
+  if (aSubShapeId > 0)
+  {
+    myPickedPrs = new AIS_Shape (myIdPicker.SubShape (aSubShapeId));
+    myPickedPrs->SetWidth (3.0);
+    myPickedPrs->SetColor (myContext->HighlightStyle (Prs3d_TypeOfHighlight_Selected)->Color());
+    myPickedPrs->Attributes()->ShadingAspect()->Aspect()->SetPolygonOffsets (Aspect_POM_Fill, -1.0f, -1.0f); // draw over the shape
+    myContext->Display (myPickedPrs, AIS_Shaded, -1, Standard_False);
+  }
+  myView->Invalidate();
+  Message::SendInfo (TCollection_AsciiString() + "GPU picking of " + (aSubShapeId > myIdPicker.NbFaces() ? "edge " : "face ")
+                   + aSubShapeId + "/" + (myIdPicker.NbFaces() + myIdPicker.NbEdges())
+                   + " in " + aTimer.ElapsedTime() * 1000.0 + " ms");
+}
+
+// ================================================================
+// Function : handleSelectionPick
+// Purpose  :
+// ================================================================
+void OcctJni_Viewer::handleSelectionPick (const Handle(AIS_InteractiveContext)& theCtx,
+                                          const Handle(V3d_View)& theView)
+{
+  if (myGL.Selection.Points.IsEmpty())
+  {
+    AIS_ViewController::handleSelectionPick (theCtx, theView);
+    return;
+  }
+
+  // the first pick also builds selection structures
+  OSD_Timer aTimer;
+  aTimer.Start();
+  const Standard_Size aHeapBefore = OSD_MemInfo().Value (OSD_MemInfo::MemHeapUsage);
+  AIS_ViewController::handleSelectionPick (theCtx, theView);
+  const Standard_Size aHeapAfter = OSD_MemInfo().Value (OSD_MemInfo::MemHeapUsage);
+  aTimer.Stop();
+  Message::SendInfo (TCollection_AsciiString() + "CPU picking in " + aTimer.ElapsedTime() * 1000.0 + " ms"
+                   + " (heap +" + (Standard_Integer )(aHeapAfter > aHeapBefore ? (aHeapAfter - aHeapBefore) / 1024 : 0) + " KiB)");
+}
+
 #define jexp extern "C" JNIEXPORT
 
 jexp jlong JNICALL Java_com_opencascade_jnisample_OcctJniRenderer_cppCreate (JNIEnv* theEnv,
@@ -599,6 +1373,50 @@ jexp void JNICALL Java_com_opencascade_jnisample_OcctJniRenderer_cppOpen (JNIEnv
   ((OcctJni_Viewer* )theCppPtr)->open (aPath);
 }
 
+jexp void JNICALL Java_com_opencascade_jnisample_OcctJniRenderer_cppOpenFd (JNIEnv* theEnv,
+                                                                            jobject theObj,
+                                                                            jlong   theCppPtr,
+                                                                            jint    theFd,
+                                                                            jstring theName)
+{
+  const char* aNamePtr = theEnv->GetStringUTFChars (theName, 0);
+  const TCollection_AsciiString aName (aNamePtr);
+  theEnv->ReleaseStringUTFChars (theName, aNamePtr);
+  ((OcctJni_Viewer* )theCppPtr)->openFd (theFd, aName);
+}
+
+jexp void JNICALL Java_com_opencascade_jnisample_OcctJniRenderer_cppOpenBuffer (JNIEnv* theEnv,
+                                                                                jobject theObj,
+                                                                                jlong   theCppPtr,
+                                                                                jobject theBuffer,
+                                                                                jint    thePosition,
+                                                                                jint    theLimit,
+                                                                                jstring theName)
+{
+  const char* aNamePtr = theEnv->GetStringUTFChars (theName, 0);
+  const TCollection_AsciiString aName (aNamePtr);
+  theEnv->ReleaseStringUTFChars (theName, aNamePtr);
+
+  const char* aData = (const char* )theEnv->GetDirectBufferAddress (theBuffer);
+  const jlong aCapacity = theEnv->GetDirectBufferCapacity (theBuffer);
+  if (aData == NULL
+   || aCapacity < 0)
+  {
+    Message::SendFail (TCollection_AsciiString() + "Error: file '" + aName + "' can not be opened - buffer is not direct");
+    return;
+  }
+  if (thePosition < 0
+   || thePosition > theLimit
+   || (jlong )theLimit > aCapacity)
+  {
+    Message::SendFail (TCollection_AsciiString() + "Error: file '" + aName + "' can not be opened - invalid buffer range");
+    return;
+  }
+
+  // read only remaining data of the buffer, which might be a slice of larger one
+  ((OcctJni_Viewer* )theCppPtr)->openBuffer (aData + thePosition, (size_t )(theLimit - thePosition), aName);
+}
+
 jexp jboolean JNICALL Java_com_opencascade_jnisample_OcctJniRenderer_cppRedraw (JNIEnv* theEnv,
                                                                                 jobject theObj,
                                                                                 jlong   theCppPtr)
@@ -606,6 +1424,13 @@ jexp jboolean JNICALL Java_com_opencascade_jnisample_OcctJniRenderer_cppRedraw (
   return ((OcctJni_Viewer* )theCppPtr)->redraw() ? JNI_TRUE : JNI_FALSE;
 }
 
+jexp jboolean JNICALL Java_com_opencascade_jnisample_OcctJniRenderer_cppHasBackgroundWork (JNIEnv* theEnv,
+                                                                                           jobject theObj,
+                                                                                           jlong   theCppPtr)
+{
+  return ((OcctJni_Viewer* )theCppPtr)->hasBackgroundWork() ? JNI_TRUE : JNI_FALSE;
+}
+
 jexp void JNICALL Java_com_opencascade_jnisample_OcctJniRenderer_cppSetAxoProj (JNIEnv* theEnv,
                                                                                 jobject theObj,
                                                                                 jlong   theCppPtr)
@@ -696,7 +1521,40 @@ jexp void JNICALL Java_com_opencascade_jnisample_OcctJniRenderer_cppSelectInView
                                                                                     jfloat  theX,
                                                                                     jfloat  theY)
 {
-  ((OcctJni_Viewer* )theCppPtr)->SelectInViewer (Graphic3d_Vec2i ((int )theX, (int )theY));
+  ((OcctJni_Viewer* )theCppPtr)->selectInViewer (Graphic3d_Vec2i ((int )theX, (int )theY));
+}
+
+jexp void JNICALL Java_com_opencascade_jnisample_OcctJniRenderer_cppSetCompactVertices (JNIEnv* theEnv,
+                                                                                        jobject  theObj,
+                                                                                        jlong    theCppPtr,
+                                                                                        jboolean theToUseCompact)
+{
+  ((OcctJni_Viewer* )theCppPtr)->setCompactVertices (theToUseCompact == JNI_TRUE);
+}
+
+jexp void JNICALL Java_com_opencascade_jnisample_OcctJniRenderer_cppSetOcclusionCulling (JNIEnv* theEnv,
+                                                                                         jobject  theObj,
+                                                                                         jlong    theCppPtr,
+                                                                                         jboolean theToCull)
+{
+  ((OcctJni_Viewer* )theCppPtr)->setOcclusionCulling (theToCull == JNI_TRUE);
+}
+
+jexp void JNICALL Java_com_opencascade_jnisample_OcctJniRenderer_cppSetGpuPicking (JNIEnv* theEnv,
+                                                                                   jobject  theObj,
+                                                                                   jlong    theCppPtr,
+                                                                                   jboolean theToUseGpu)
+{
+  ((OcctJni_Viewer* )theCppPtr)->setGpuPicking (theToUseGpu == JNI_TRUE);
+}
+
+jexp void JNICALL Java_com_opencascade_jnisample_OcctJniRenderer_cppSetSectionPlane (JNIEnv* theEnv,
+                                                                                     jobject theObj,
+                                                                                     jlong   theCppPtr,
+                                                                                     jint    theAxis,
+                                                                                     jfloat  thePosition)
+{
+  ((OcctJni_Viewer* )theCppPtr)->setSectionPlane (theAxis, thePosition);
 }
 
 jexp jlong JNICALL Java_com_opencascade_jnisample_OcctJniActivity_cppOcctMajorVersion (JNIEnv* theEnv,
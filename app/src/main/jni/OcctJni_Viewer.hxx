@@ -19,8 +19,18 @@
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
 
+#include "OcctJni_CompactShape.hxx"
+#include "OcctJni_IdPicker.hxx"
+#include "OcctJni_OcclusionCuller.hxx"
+#include "OcctJni_SectionBuilder.hxx"
+
 #include <AIS_InteractiveContext.hxx>
+#include <AIS_Shape.hxx>
+#include <AIS_TextLabel.hxx>
 #include <AIS_ViewController.hxx>
+#include <Bnd_Box.hxx>
+#include <Graphic3d_ClipPlane.hxx>
+#include <OSD_Timer.hxx>
 #include <TopoDS_Shape.hxx>
 #include <V3d_Viewer.hxx>
 #include <V3d_View.hxx>
@@ -49,6 +59,22 @@ public:
   //! Open CAD file
   bool open (const TCollection_AsciiString& thePath);
 
+  //! Open CAD file from file descriptor without making a copy.
+  //! The descriptor is closed afterwards.
+  //! @param theFd   opened file descriptor
+  //! @param theName file name defining the format
+  bool openFd (int theFd,
+               const TCollection_AsciiString& theName);
+
+  //! Open CAD file from memory buffer (e.g. memory-mapped file) without making a copy.
+  //! Only STEP, BRep and STL formats can be read from memory.
+  //! @param theData buffer content
+  //! @param theSize buffer size
+  //! @param theName file name defining the format
+  bool openBuffer (const char* theData,
+                   size_t      theSize,
+                   const TCollection_AsciiString& theName);
+
   //! Take snapshot
   bool saveSnapshot (const TCollection_AsciiString& thePath,
                      int theWidth  = 0,
@@ -58,6 +84,14 @@ public:
   //! Returns TRUE if more frames should be requested.
   bool redraw();
 
+  //! Returns TRUE if exact section is scheduled or being computed,
+  //! so that the viewer should be polled for the result.
+  bool hasBackgroundWork() const
+  {
+    return myIsSectionPending
+        || mySectionBuilder.IsBusy();
+  }
+
   //! Move camera
   void setProj (V3d_TypeOfOrientation theProj)
   {
@@ -73,14 +107,69 @@ public:
   //! Fit All.
   void fitAll();
 
+  //! Set section plane.
+  //! Clipping plane is applied to the shape immediately,
+  //! while exact section is computed in background after plane stops moving.
+  //! @param theAxis     plane normal (0 for X, 1 for Y, 2 for Z) or -1 to turn sectioning off
+  //! @param thePosition plane position within shape bounding box in [0, 1] range
+  void setSectionPlane (int    theAxis,
+                        double thePosition);
+
+  //! Switch picking mode.
+  //! @param theToUseGpu when TRUE, faces are picked by rendering their IDs on GPU
+  //!                    instead of selection through CPU-side sensitive entities
+  void setGpuPicking (bool theToUseGpu);
+
+  //! Switch compact (quantized) vertex format of shaded presentation.
+  void setCompactVertices (bool theToUseCompact);
+
+  //! Switch occlusion culling of assembly parts.
+  void setOcclusionCulling (bool theToCull);
+
+  //! Select object at the point.
+  void selectInViewer (const Graphic3d_Vec2i& thePnt);
+
 protected:
 
+  //! Load the shape from the file or stream and display it.
+  //! @param theName   file name defining the format
+  //! @param thePath   file path to read from when theStream is NULL
+  //! @param theStream stream to read from
+  bool openShape (const TCollection_AsciiString& theName,
+                  const TCollection_AsciiString& thePath,
+                  std::istream* theStream);
+
+  //! Display the shape.
+  void displayShape (const TopoDS_Shape& theShape);
+
+  //! Remove presentations of displayed shape.
+  void eraseShape();
+
+  //! Add or remove section clipping plane to presentations of displayed shape.
+  void setShapeClipPlane (bool theToAdd);
+
+  //! Report size of compact vertex data comparing to float format.
+  void reportVertexData();
+
+  //! Update label with occlusion culling statistics.
+  void updateCullingLabel();
+
+  //! Update clipping plane and schedule exact section computation.
+  void updateSectionPlane();
+
+  //! Start exact section computation once plane stops moving and display computed section.
+  void updateSection();
+
   //! Reset viewer content.
   void initContent();
 
   //! Print information about OpenGL ES context.
   void dumpGlInfo (bool theIsBasic);
 
+  //! Perform selection, reporting time and memory consumption.
+  virtual void handleSelectionPick (const Handle(AIS_InteractiveContext)& theCtx,
+                                    const Handle(V3d_View)& theView) override;
+
   //! Handle redraw.
   virtual void handleViewRedraw (const Handle(AIS_InteractiveContext)& theCtx,
                                  const Handle(V3d_View)& theView) override;
@@ -93,6 +182,23 @@ protected:
   Handle(Prs3d_TextAspect)       myTextStyle; //!< text style for OSD elements
   Handle(AIS_ViewCube)           myViewCube;  //!< view cube object
   TopoDS_Shape                   myShape;
+  Handle(AIS_Shape)              myShapePrs;   //!< presentation of displayed shape
+  Handle(AIS_Shape)              mySectionPrs; //!< presentation of exact section
+  Handle(Graphic3d_ClipPlane)    myClipPlane;  //!< clipping plane for interactive section
+  OcctJni_SectionBuilder         mySectionBuilder; //!< background computation of exact sections
+  OSD_Timer                      mySectionTimer;   //!< time elapsed since last section plane movement
+  Bnd_Box                        myShapeBox;       //!< bounding box of displayed shape
+  OcctJni_IdPicker               myIdPicker;       //!< GPU picking tool
+  Handle(AIS_Shape)              myPickedPrs;      //!< highlighting of face picked on GPU
+  OcctJni_OcclusionCuller        myOcclusionCuller; //!< occlusion culling of assembly parts
+  Handle(AIS_TextLabel)          myCullingLabel;    //!< occlusion culling statistics
+  double                         mySectionPos;     //!< section plane position within bounding box
+  int                            mySectionAxis;    //!< section plane normal axis or -1 if sectioning is off
+  int                            mySectionKey;     //!< key of current section plane position
+  bool                           myIsSectionPending; //!< exact section has not been requested yet
+  bool                           myToPickOnGpu;      //!< pick faces on GPU instead of CPU selection
+  bool                           myToCullOccluded;   //!< display assembly parts individually and cull occluded ones
+  bool                           myToUseCompactVertices; //!< display shaded presentation in compact vertex format
   float                          myDevicePixelRatio; //!< device pixel ratio for handling high DPI displays
   bool                           myIsJniMoreFrames;  //!< need more frame flag
 